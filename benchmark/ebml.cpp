@@ -0,0 +1,222 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+// Walks the element headers inside the clusters of a video, i.e. the EBML IDs
+// and sizes of timecodes, blocks and block groups, and prints the decoded
+// headers per second for each way of decoding them:
+//   bytewise  one reader call per byte, as mkvparser did before
+//   reader    mkvparser::ReadID and ReadUInt, one reader call per value
+//   buffer    mkvparser::DecodeID and DecodeUInt on memory
+// The video is held in memory, so the numbers show the decoding cost only, e.g.
+//   benchmark_ebml 720p.webm
+
+#include "mkvparser/mkvparser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Reader on a video held in memory
+class BufferReader : public mkvparser::IMkvReader
+{
+public:
+	BufferReader(const std::vector<unsigned char>& data) : _data(data)
+	{
+		// Do nothing
+	}
+
+	int Read(long long pos, long len, unsigned char* buf)
+	{
+		if (pos < 0 || len < 0 || pos + len > (long long)_data.size())
+			return -1;
+		std::memcpy(buf, _data.data() + pos, len);
+		return 0;
+	}
+
+	int Length(long long* total, long long* available)
+	{
+		if (total)
+			*total = (long long)_data.size();
+		if (available)
+			*available = (long long)_data.size();
+		return 0;
+	}
+
+private:
+	const std::vector<unsigned char>& _data;
+};
+
+// Byte range of a cluster body
+struct Body
+{
+	long long start;
+	long long stop;
+};
+
+// Decoding as mkvparser did before, one reader call per byte
+long long bytewise_vint(mkvparser::IMkvReader* p_reader, long long pos, long& len, bool id)
+{
+	unsigned char b;
+	if (p_reader->Read(pos, 1, &b) != 0 || b == 0)
+		return -1;
+	len = 1;
+	unsigned char m = 0x80;
+	while (!(b & m))
+	{
+		m >>= 1;
+		++len;
+	}
+	long long result = id ? b : (b & ~m);
+	for (long i = 1; i < len; ++i)
+	{
+		if (p_reader->Read(pos + i, 1, &b) != 0)
+			return -1;
+		result = (result << 8) | b;
+	}
+	return result;
+}
+
+// Walks the element headers of one body and returns how many were decoded, 0 on error
+template<typename Decode>
+unsigned long walk_body(const Body& body, Decode decode)
+{
+	unsigned long count = 0;
+	long long pos = body.start;
+	while (pos < body.stop)
+	{
+		long len = 0;
+		const long long id = decode(pos, len, true);
+		if (id < 0)
+			return 0;
+		pos += len;
+		const long long size = decode(pos, len, false);
+		if (size < 0)
+			return 0;
+		pos += len;
+		++count;
+
+		// Descend into block groups, everything else is skipped
+		if (id != 0xA0)
+			pos += size;
+	}
+	return count;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::printf("Usage: %s <video.webm> [<iterations>]\n", argv[0]);
+		return 1;
+	}
+	const int iterations = argc > 2 ? std::atoi(argv[2]) : 100;
+
+	// Load video into memory
+	std::vector<unsigned char> data;
+	if (FILE* p_file = std::fopen(argv[1], "rb"))
+	{
+		unsigned char chunk[1 << 16];
+		size_t size;
+		while ((size = std::fread(chunk, 1, sizeof(chunk), p_file)) > 0)
+		{
+			data.insert(data.end(), chunk, chunk + size);
+		}
+		std::fclose(p_file);
+	}
+	BufferReader reader(data);
+
+	// Collect cluster bodies
+	std::vector<Body> bodies;
+	long long pos = 0;
+	mkvparser::EBMLHeader ebml_header;
+	mkvparser::Segment* p_segment = NULL;
+	if (ebml_header.Parse(&reader, pos) < 0
+		|| mkvparser::Segment::CreateInstance(&reader, pos, p_segment) != 0
+		|| p_segment->Load() < 0)
+	{
+		std::fprintf(stderr, "Could not open %s\n", argv[1]);
+		delete p_segment;
+		return 1;
+	}
+	for (const mkvparser::Cluster* p_cluster = p_segment->GetFirst();
+		p_cluster && !p_cluster->EOS();
+		p_cluster = p_segment->GetNext(p_cluster))
+	{
+		long long start = p_cluster->m_element_start;
+		long len;
+		if (mkvparser::ReadID(&reader, start, len) < 0)
+			continue;
+		start += len;
+		const long long size = mkvparser::ReadUInt(&reader, start, len);
+		if (size < 0 || size == (1LL << (7 * len)) - 1) // clusters of unknown size are skipped
+			continue;
+		start += len;
+		bodies.push_back(Body{ start, start + size });
+	}
+	delete p_segment;
+
+	// Decoders to compare
+	const unsigned char* p_data = data.data();
+	const long long data_size = (long long)data.size();
+	auto bytewise = [&](long long pos, long& len, bool id)
+	{
+		return bytewise_vint(&reader, pos, len, id);
+	};
+	auto via_reader = [&](long long pos, long& len, bool id)
+	{
+		return id ? mkvparser::ReadID(&reader, pos, len) : mkvparser::ReadUInt(&reader, pos, len);
+	};
+	auto via_buffer = [&](long long pos, long& len, bool id)
+	{
+		const long size = (long)std::min<long long>(8, data_size - pos);
+		return id ? mkvparser::DecodeID(p_data + pos, size, len) : mkvparser::DecodeUInt(p_data + pos, size, len);
+	};
+
+	std::printf("file,clusters,method,headers,seconds,headers_per_second\n");
+	const char* names[] = { "bytewise", "reader", "buffer" };
+	for (int m = 0; m < 3; ++m)
+	{
+		unsigned long long count = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			for (const Body& body : bodies)
+			{
+				switch (m)
+				{
+				case 0: count += walk_body(body, bytewise); break;
+				case 1: count += walk_body(body, via_reader); break;
+				default: count += walk_body(body, via_buffer); break;
+				}
+			}
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%s,%u,%s,%llu,%.3f,%.0f\n",
+			argv[1], (unsigned int)bodies.size(), names[m], count, seconds, seconds > 0.0 ? count / seconds : 0.0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+// Decodes every given video with each threading policy and a range of thread
+// counts and prints the decoded frames per second as one row per combination.
+// Pass videos of different resolutions to get the full matrix, e.g.
+//   benchmark_threading 360p.webm 720p.webm 1080p.webm 2160p.webm
+
+#include "libsimplewebm.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::printf("Usage: %s <video.webm> [<video.webm> ...]\n", argv[0]);
+		return 1;
+	}
+
+	// Thread counts to try, up to the core count of the machine
+	const int cores = (int)std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<int> thread_counts;
+	for (int t = 1; t < cores; t *= 2)
+	{
+		thread_counts.push_back(t);
+	}
+	thread_counts.push_back(cores);
+
+	// Policies to try
+	const simplewebm::Threading policies[] = { simplewebm::Threading::TILE, simplewebm::Threading::FRAME, simplewebm::Threading::AUTO };
+	const char* policy_names[] = { "tile", "frame", "auto" };
+
+	std::printf("file,resolution,policy,threads,frames,seconds,fps\n");
+	for (int f = 1; f < argc; ++f)
+	{
+		// Get resolution from the first frame
+		auto sp_first = std::make_shared<std::vector<simplewebm::Image> >();
+		if (simplewebm::create_video_walker(argv[f])->walk(sp_first, 1) == simplewebm::Status::ERR_FILE_NOT_FOUND || sp_first->empty())
+		{
+			std::fprintf(stderr, "Could not open %s\n", argv[f]);
+			continue;
+		}
+
+		for (int p = 0; p < 3; ++p)
+		{
+			for (int threads : thread_counts)
+			{
+				// Dry walk decodes every frame but skips the colour conversion
+				auto walker = simplewebm::create_video_walker(argv[f], threads, policies[p]);
+				auto sp_times = std::make_shared<std::vector<double> >();
+				unsigned int count = 0;
+				const auto start = std::chrono::steady_clock::now();
+				walker->dry_walk(sp_times, 0, &count);
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				std::printf("%s,%dx%d,%s,%d,%u,%.3f,%.1f\n",
+					argv[f], sp_first->at(0).width, sp_first->at(0).height, policy_names[p], threads,
+					count, seconds, seconds > 0.0 ? count / seconds : 0.0);
+			}
+		}
+	}
+
+	return 0;
+}
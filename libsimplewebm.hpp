@@ -27,6 +27,13 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <future>
 
 namespace simplewebm
 {
@@ -35,7 +42,62 @@ namespace simplewebm
 		OK, // everything ok, go on
 		DONE, // walked over complete video, i am done
 		ERR_FILE_NOT_FOUND, // file not found
-		ERR_ODD_DIMENSION }; // width and / or height have odd dimension, cannot proceed
+		ERR_ODD_DIMENSION, // width and / or height have odd dimension, cannot proceed
+		ERR_INVALID_FILE, // file is no WebM file or its headers are broken
+		CANCELLED, // walk was cancelled through its token
+		DEADLINE_EXCEEDED }; // walk did not finish before its deadline
+
+	// Threading policy of the decoder
+	enum class Threading {
+		AUTO, // tile threading while the tile columns of the video can keep all threads busy, frame threading otherwise
+		TILE, // low latency, parallelism limited by the tile columns of the video
+		FRAME }; // high throughput for VP9, adds one frame of latency per additional thread
+
+	// Video codec of a file
+	enum class VideoCodec {
+		NONE, // no supported video track
+		VP8,
+		VP9 };
+
+	// Audio codec of a file
+	enum class AudioCodec {
+		NONE, // no supported audio track
+		VORBIS,
+		OPUS };
+
+	// Metadata of a video from its headers. Values the file does not store are left at their defaults.
+	class VideoInfo
+	{
+	public:
+		VideoCodec codec = VideoCodec::NONE; // codec of the first supported video track
+		int width = 0;
+		int height = 0;
+		double duration = -1.0; // duration in seconds, negative when not stored
+		double frame_rate = 0.0; // frames per second from frame rate or default duration, zero when not stored
+		long long colour_matrix = -1; // MatrixCoefficients, -1 when not stored
+		long long colour_range = -1; // Range, -1 when not stored
+		long long colour_transfer = -1; // TransferCharacteristics, -1 when not stored
+		long long colour_primaries = -1; // Primaries, -1 when not stored
+		long long colour_bits_per_channel = -1; // BitsPerChannel, -1 when not stored
+		AudioCodec audio_codec = AudioCodec::NONE; // codec of the first supported audio track
+		int video_track_count = 0; // count of supported video tracks
+		bool has_cues = false; // whether file has an index for seeking
+	};
+
+	// Inventory record of one file, see probe_all
+	class ProbeRecord
+	{
+	public:
+		std::string path;
+		Status status = Status::ERR_FILE_NOT_FOUND;
+		VideoInfo info;
+		long long file_size = 0; // bytes
+		bool duration_estimated = false; // whether duration is missing in the header and was measured at the last cluster
+		long long frame_count = -1; // estimate from duration and frame rate, -1 when unknown
+		bool frame_count_estimated = false; // whether frame rate is missing in the header and frame_count uses the average frame interval of the last cluster
+		long cue_count = 0; // cue points of the video track, usually one per keyframe or cluster
+		double keyframe_interval = -1.0; // average seconds between cue points, negative when unknown
+	};
 
 	// Simple image class to hold data of one frame from movie
 	class Image
@@ -45,6 +107,165 @@ namespace simplewebm
 		int height = 0;
 		std::vector<char> data; // BGR pixels
 		double time = 0.0; // Frame time in seconds
+		bool duplicate = false; // Whether frame equals the previous one, see DuplicateOptions
+	};
+
+	// Rectangle of pixels
+	class Rect
+	{
+	public:
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	// Receives the canvas of a change walk and the regions that changed since the previous frame, return false to stop walking.
+	// Only the changed regions of the canvas have been converted, the rest shows earlier frames.
+	typedef std::function<bool(const Image& canvas, const std::vector<Rect>& changes)> ChangeSink;
+
+	// Receives frames of a walk by reference. The frame is recycled after returning, return false to stop walking.
+	typedef std::function<bool(const Image&)> FrameSink;
+
+	// Receives the ticks of a constant frame rate walk with their time in seconds, return false to stop walking.
+	// Ticks showing the same frame share its image, which stays valid as long as it is referenced.
+	typedef std::function<bool(double time, const std::shared_ptr<const Image>& sp_image)> TickSink;
+
+	// Receives frames of a multi-track walk by reference, tagged with the index of their track among the supported video tracks.
+	// The frame is released after returning, return false to stop walking.
+	typedef std::function<bool(int track, const Image&)> TrackFrameSink;
+
+	// Compressed audio packet as stored in the file, for decoding with libopus or libvorbis outside of this library
+	class AudioPacket
+	{
+	public:
+		const unsigned char* data = nullptr; // payload, valid until the sink returns
+		size_t size = 0; // bytes of payload
+		double time = 0.0; // packet time in seconds
+	};
+
+	// Receives packets of an audio walk by reference, return false to stop walking.
+	typedef std::function<bool(const AudioPacket&)> AudioPacketSink;
+
+	// Options of a lazy frame range. Frames outside of the options are never converted.
+	class FrameRangeOptions
+	{
+	public:
+		double from = 0.0; // skip frames before this time in seconds
+		double to = std::numeric_limits<double>::max(); // end range at first frame after this time in seconds
+		unsigned int stride = 1; // deliver every stride-th frame within time range
+		unsigned int take = 0; // end range after this many frames, zero for no limit
+	};
+
+	// Options of a sampling walk, only one way of selecting frames applies: times, else fps, else every.
+	// Frames that are not selected are decoded only when later frames reference them and are never converted.
+	class SamplingOptions
+	{
+	public:
+		std::vector<double> times; // select the frame nearest to each time in seconds, ascending
+		double fps = 0.0; // select the frame nearest to each tick of 1 / fps seconds from the first frame on, zero for none
+		unsigned int every = 1; // select every n-th frame
+	};
+
+	// Source of a lazy frame range, implemented by the walker
+	class FrameSource
+	{
+	public:
+		virtual ~FrameSource() {}
+		virtual bool advance() = 0; // decode next selected frame without converting it, returns false at end of range
+		virtual const Image& current() = 0; // convert current frame on first access
+		virtual Status status() const = 0; // OK while frames are left, DONE at end of video or error
+	};
+
+	// Input iterator over a lazy frame range
+	class FrameIterator
+	{
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef Image value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const Image* pointer;
+		typedef const Image& reference;
+
+		FrameIterator() {} // end of range
+		explicit FrameIterator(std::shared_ptr<FrameSource> sp_source) : _sp_source(sp_source) {}
+		reference operator*() const { return _sp_source->current(); }
+		pointer operator->() const { return &_sp_source->current(); }
+		FrameIterator& operator++() { if (!_sp_source->advance()) { _sp_source = nullptr; } return *this; }
+		void operator++(int) { ++*this; }
+		bool operator==(const FrameIterator& other) const { return _sp_source == other._sp_source; }
+		bool operator!=(const FrameIterator& other) const { return _sp_source != other._sp_source; }
+
+	private:
+		std::shared_ptr<FrameSource> _sp_source;
+	};
+
+	// Lazy range of frames, decoding happens while iterating and conversion when dereferencing.
+	// Single pass only, the walker must outlive the range.
+	class FrameRange
+	{
+	public:
+		explicit FrameRange(std::shared_ptr<FrameSource> sp_source) : _sp_source(sp_source) {}
+		FrameIterator begin() const { return _sp_source->advance() ? FrameIterator(_sp_source) : FrameIterator(); }
+		FrameIterator end() const { return FrameIterator(); }
+		Status status() const { return _sp_source->status(); }
+
+	private:
+		std::shared_ptr<FrameSource> _sp_source;
+	};
+
+	// Token to cancel asynchronous walks cooperatively. Copies share the cancellation state.
+	class CancellationToken
+	{
+	public:
+		CancellationToken() : _sp_cancelled(std::make_shared<std::atomic<bool> >(false)) {}
+		void cancel() { _sp_cancelled->store(true); }
+		bool is_cancelled() const { return _sp_cancelled->load(); }
+
+	private:
+		std::shared_ptr<std::atomic<bool> > _sp_cancelled;
+	};
+
+	// Options of an asynchronous walk. Cancellation and deadline are checked between frames.
+	class AsyncOptions
+	{
+	public:
+		unsigned int count_to_extract = 0; // zero will walk over complete video
+		CancellationToken token;
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+		std::function<void(Status, unsigned int)> on_complete; // called with status and extracted count, optional
+	};
+
+	// Options to follow a file that is still being written, e.g. by a live recorder.
+	// Walks wait for more data at the end of the file instead of ending, polling its size with growing intervals.
+	class FollowOptions
+	{
+	public:
+		bool enabled = false;
+		std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(10000); // walk ends once the file has not grown for this long
+		std::chrono::milliseconds min_poll_interval = std::chrono::milliseconds(10);
+		std::chrono::milliseconds max_poll_interval = std::chrono::milliseconds(500);
+	};
+
+	// Options of duplicate detection, which compares the YUV planes of each decoded frame with the last frame that was
+	// not a duplicate before conversion, e.g. to follow the actual changes of a screen recording
+	class DuplicateOptions
+	{
+	public:
+		bool enabled = false;
+		bool suppress = false; // walks skip duplicates instead of flagging them, random access and sampling keep them
+		double threshold = 0.0; // sum of absolute differences per luma pixel up to which a frame is a duplicate
+	};
+
+	// Statistics of the decoded frame cache
+	class CacheStats
+	{
+	public:
+		unsigned long long hits = 0;
+		unsigned long long misses = 0;
+		size_t resident_bytes = 0;
+		size_t resident_frames = 0;
+		double hit_rate() const { return (hits + misses) > 0 ? (double)hits / (double)(hits + misses) : 0.0; }
 	};
 
 	// Video walker to fetch consecutive range of images from video
@@ -61,12 +282,89 @@ namespace simplewebm
 			const unsigned int count_to_extract = 0,
 			unsigned int * p_extracted_count = nullptr) = 0;
 
+		// Walk over video and hand each frame to sink, returns status. count_to_extract == 0 will walk over complete video.
+		// Only one frame is held in memory, independent of the length of the video.
+		virtual Status walk(
+			const FrameSink& sink,
+			const unsigned int count_to_extract = 0,
+			unsigned int * p_extracted_count = nullptr) = 0;
+
+		// Walk over the frames with times between from and to in seconds and hand them to sink, returns status.
+		// Starts at the keyframe at or before from, frames before from are decoded without conversion and
+		// demuxing stops at the first frame after to, so that the work depends on the length of the range only.
+		virtual Status walk_range(
+			const double from,
+			const double to,
+			const FrameSink& sink,
+			unsigned int * p_extracted_count = nullptr) = 0;
+
+		// Walk over video from the current position and hand the selected frames to sink, returns status.
+		// A frame nearest to several times or ticks is handed once for each of them.
+		virtual Status walk_sampled(
+			const SamplingOptions& options,
+			const FrameSink& sink,
+			unsigned int * p_extracted_count = nullptr) = 0;
+
+		// Walk over video from the current position at a constant frame rate and hand each tick to sink, returns status.
+		// Ticks are 1 / fps seconds apart from the first frame on, each tick shows the last frame at or before its time and
+		// ticks end with the video. Frames shown by no tick are never converted.
+		virtual Status walk_cfr(
+			const double fps,
+			const TickSink& sink,
+			unsigned int * p_tick_count = nullptr) = 0;
+
+		// Walk over video at a constant frame rate like above and append the image of each tick, returns status.
+		// Ticks showing the same frame share its image, e.g. a static screen costs one frame of memory.
+		virtual Status walk_cfr(
+			const double fps,
+			std::shared_ptr<std::vector<std::shared_ptr<const Image> > > sp_ticks,
+			unsigned int * p_tick_count = nullptr) = 0;
+
+		// Walk over video from the current position, converting only the tiles of tile_size pixels that changed since the
+		// previous frame into canvas, and hand canvas and changed regions to sink, returns status. The first frame and
+		// frames of other size change as a whole. Conversion work follows the changed area instead of the frame count.
+		virtual Status walk_changes(
+			Image& canvas,
+			const ChangeSink& sink,
+			const int tile_size = 64,
+			unsigned int * p_extracted_count = nullptr) = 0;
+
+		// Walk over video on a thread of its own, sink is called from that thread.
+		// The walker must neither be used nor destroyed until the returned future is ready, destroying the future waits for the walk.
+		virtual std::future<Status> walk_async(
+			const FrameSink& sink,
+			const AsyncOptions& options = AsyncOptions()) = 0;
+
+		// Lazy range over the frames from the current position on, e.g. for (const auto& frame : walker->frames(options))
+		virtual FrameRange frames(const FrameRangeOptions& options = FrameRangeOptions()) = 0;
+
 		// Dry walk over the video to gather frame times, returns status. count_to_extract == 0 will walk over complete video.
 		virtual Status dry_walk(
 			std::shared_ptr<std::vector<double> > sp_times,
 			const unsigned int count_to_extract = 0,
 			unsigned int * p_extracted_count = nullptr) = 0;
 
+		// Get frame shown at time in seconds, returns status. Times before the first frame yield the first frame.
+		// Decodes forward from the preceding keyframe, walking continues after the returned frame.
+		virtual Status get_frame_at(const double time, Image& image) = 0;
+
+		// Get frames shown at times in seconds, appended in order of the times, returns status.
+		// Times are visited sorted, so that times within the same group of pictures share one decode pass.
+		virtual Status get_frames_at(
+			const std::vector<double>& times,
+			std::shared_ptr<std::vector<Image> > sp_images) = 0;
+
+		// Keep up to max_bytes of frames returned by random access in a least recently used cache,
+		// so that repeated requests around the same times are served without decoding. Zero disables the cache.
+		virtual void set_frame_cache(const size_t max_bytes) = 0;
+
+		// Get hit rate and resident memory of the frame cache
+		virtual CacheStats get_frame_cache_stats() const = 0;
+
+		// Flag or suppress frames that duplicate the previous frame. Constant frame rate walks share the image of the
+		// previous frame for duplicates instead of converting them.
+		virtual void set_duplicate_detection(const DuplicateOptions& options) = 0;
+
 	protected:
 
 		// Constructor
@@ -75,6 +373,106 @@ namespace simplewebm
 		VideoWalker& operator=(VideoWalker const&) = delete;
 	};
 
-	// Factory of video walker
-	std::unique_ptr<VideoWalker> create_video_walker(const std::string webm_filepath, const int thread_count = 1);
+	// Walker over several video tracks of one file, e.g. a multi-camera recording.
+	// The file is demuxed once, each track is decoded by its own decoder and the decoders run in parallel.
+	class MultiTrackWalker
+	{
+	public:
+
+		// Destructor
+		virtual ~MultiTrackWalker() = 0;
+
+		// Walk over the selected tracks and hand their frames to sink ordered by time, returns status.
+		// count_to_extract counts frames of all tracks, count_to_extract == 0 will walk over complete video.
+		virtual Status walk(
+			const TrackFrameSink& sink,
+			const unsigned int count_to_extract = 0,
+			unsigned int * p_extracted_count = nullptr) = 0;
+
+		// Indices of the selected tracks among the supported video tracks of the file
+		virtual const std::vector<int>& get_tracks() const = 0;
+
+	protected:
+
+		// Constructor
+		MultiTrackWalker();
+		MultiTrackWalker(const MultiTrackWalker&) = delete;
+		MultiTrackWalker& operator=(MultiTrackWalker const&) = delete;
+	};
+
+	// Audio walker to fetch the compressed packets of the first supported audio track, without decoding them
+	class AudioWalker
+	{
+	public:
+
+		// Destructor
+		virtual ~AudioWalker() = 0;
+
+		// Walk over audio and hand each packet to sink, returns status. count_to_extract == 0 will walk over complete audio.
+		virtual Status walk(
+			const AudioPacketSink& sink,
+			const unsigned int count_to_extract = 0,
+			unsigned int * p_extracted_count = nullptr) = 0;
+
+		// Continue walking at the start of the cluster holding time minus the seek pre-roll, returns status.
+		// Decoders get enough packets before time to converge, packets before time are to be decoded and discarded.
+		virtual Status seek(const double time) = 0;
+
+		// Codec of the audio track, NONE when the file has no supported audio track
+		virtual AudioCodec get_codec() const = 0;
+
+		// CodecPrivate of the audio track, i.e. the Vorbis header packets in Xiph lacing or the OpusHead
+		virtual const std::vector<unsigned char>& get_codec_private() const = 0;
+
+		// Seconds to decode before a seek target, e.g. 80 ms for Opus
+		virtual double get_seek_pre_roll() const = 0;
+
+		// Seconds of decoded audio to drop at the start, e.g. the Opus pre-skip
+		virtual double get_codec_delay() const = 0;
+
+		// Sampling rate in Hz and channel count
+		virtual double get_sample_rate() const = 0;
+		virtual int get_channels() const = 0;
+
+	protected:
+
+		// Constructor
+		AudioWalker();
+		AudioWalker(const AudioWalker&) = delete;
+		AudioWalker& operator=(AudioWalker const&) = delete;
+	};
+
+	// Read metadata from EBML header, SeekHead, Info and Tracks only, without touching any cluster, returns status.
+	Status probe(const std::string webm_filepath, VideoInfo& info);
+
+	// Probe many files in parallel, reading headers, Cues and, without Duration element, the last cluster.
+	// thread_count == 0 will use the internal thread pool.
+	std::vector<ProbeRecord> probe_all(const std::vector<std::string>& webm_filepaths, const int thread_count = 0);
+
+	// Factory of video walker. thread_count == 0 will use all cores, negative values fall back to the default of one thread.
+	// Pass enabled follow options to walk a file while it is being written.
+	std::unique_ptr<VideoWalker> create_video_walker(
+		const std::string webm_filepath,
+		const int thread_count = 1,
+		const Threading threading = Threading::AUTO,
+		const FollowOptions& follow = FollowOptions());
+
+	// Factory of video walker over a WebM file in memory, e.g. memory mapped by the caller, which must outlive the walker.
+	// Frame payloads are decoded in place instead of being copied out of the file. thread_count as above.
+	std::unique_ptr<VideoWalker> create_memory_video_walker(
+		const unsigned char* p_data,
+		const size_t size,
+		const int thread_count = 1,
+		const Threading threading = Threading::AUTO);
+
+	// Factory of multi-track walker. tracks are indices among the supported video tracks of the file, see
+	// VideoInfo::video_track_count, empty selects all of them and unknown ones are ignored. thread_count as above is used by the decoder of each track.
+	std::unique_ptr<MultiTrackWalker> create_multi_track_walker(
+		const std::string webm_filepath,
+		const std::vector<int>& tracks = std::vector<int>(),
+		const int thread_count = 1,
+		const Threading threading = Threading::AUTO);
+
+	// Factory of audio walker
+	std::unique_ptr<AudioWalker> create_audio_walker(const std::string webm_filepath);
 }
\ No newline at end of file
@@ -12,10 +12,15 @@
 #define MSC_COMPAT
 #endif
 
+#if defined(_MSC_VER)
+#include <intrin.h>  // _BitScanReverse
+#endif
+
 #include <assert.h>
 #include <float.h>
 #include <limits.h>
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "common/webmids.h"
@@ -59,6 +64,65 @@ public:
 
 IMkvReader::~IMkvReader() {}
 
+namespace {
+const size_t kArenaAlignment = 16;
+const size_t kArenaHeaderSize =
+    (sizeof(void*) + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+const size_t kArenaMinChunkSize = 64 * 1024;
+const size_t kArenaMaxChunkSize = 4 * 1024 * 1024;
+}  // namespace
+
+Arena::Arena()
+    : m_chunks(NULL),
+      m_pos(NULL),
+      m_end(NULL),
+      m_chunk_size(kArenaMinChunkSize) {}
+
+Arena::~Arena() {
+  while (m_chunks) {
+    Chunk* const next = m_chunks->m_next;
+    free(m_chunks);
+    m_chunks = next;
+  }
+}
+
+void* Arena::Allocate(size_t size) {
+  if (size > size_t(-1) - kArenaHeaderSize - kArenaAlignment)
+    return NULL;
+
+  size = (size + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+
+  if (size <= static_cast<size_t>(m_end - m_pos)) {
+    void* const result = m_pos;
+    m_pos += size;
+    return result;
+  }
+
+  // Requests larger than half a chunk get a chunk of their own, so that the
+  // free space of the current chunk is not abandoned
+  const bool dedicated = size > m_chunk_size / 2;
+  const size_t chunk_size = dedicated ? size : m_chunk_size;
+
+  Chunk* const chunk =
+      static_cast<Chunk*>(malloc(kArenaHeaderSize + chunk_size));
+  if (chunk == NULL)
+    return NULL;
+
+  chunk->m_next = m_chunks;
+  m_chunks = chunk;
+
+  unsigned char* const data =
+      reinterpret_cast<unsigned char*>(chunk) + kArenaHeaderSize;
+  if (dedicated)
+    return data;
+
+  m_pos = data + size;
+  m_end = data + chunk_size;
+  if (m_chunk_size < kArenaMaxChunkSize)
+    m_chunk_size *= 2;
+  return data;
+}
+
 template <typename Type>
 Type* SafeArrayAlloc(unsigned long long num_elements,
                      unsigned long long element_size) {
@@ -82,10 +146,37 @@ void GetVersion(int& major, int& minor, int& build, int& revision) {
   revision = 30;
 }
 
-long long ReadUInt(IMkvReader* pReader, long long pos, long& len) {
-  if (!pReader || pos < 0)
-    return E_FILE_FORMAT_INVALID;
+namespace {
+// Largest variable-length integer, and the most bytes fetched at once.
+const long kMaxVIntLength = 8;
+
+// Length in bytes of the variable-length value starting with |b|, i.e. one
+// more than the number of leading zero bits. |b| must not be 0.
+inline long VIntLength(unsigned char b) {
+  assert(b != 0);
+#if defined(__GNUC__)
+  return __builtin_clz(b) - 23;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse(&index, b);
+  return 8 - static_cast<long>(index);
+#else
+  long len = 1;
+  for (unsigned char m = 0x80; !(b & m); m >>= 1)
+    ++len;
+  return len;
+#endif
+}
 
+// Fetches the bytes of a variable-length value with a single read. Fails near
+// the end of the available data, where the callers take the byte-wise path
+// which reports the exact error.
+inline bool ReadVIntBytes(IMkvReader* pReader, long long pos,
+                          unsigned char (&buf)[kMaxVIntLength]) {
+  return pReader->Read(pos, kMaxVIntLength, buf) == 0;
+}
+
+long long ReadUIntBytewise(IMkvReader* pReader, long long pos, long& len) {
   len = 1;
   unsigned char b;
   int status = pReader->Read(pos, 1, &b);
@@ -99,28 +190,19 @@ long long ReadUInt(IMkvReader* pReader, long long pos, long& len) {
   if (b == 0)  // we can't handle u-int values larger than 8 bytes
     return E_FILE_FORMAT_INVALID;
 
-  unsigned char m = 0x80;
-
-  while (!(b & m)) {
-    m >>= 1;
-    ++len;
-  }
+  const long length = VIntLength(b);
 
-  long long result = b & (~m);
+  long long result = b & (0xFF >> length);
   ++pos;
 
-  for (int i = 1; i < len; ++i) {
+  for (int i = 1; i < length; ++i) {
     status = pReader->Read(pos, 1, &b);
 
-    if (status < 0) {
-      len = 1;
+    if (status < 0)
       return status;
-    }
 
-    if (status > 0) {
-      len = 1;
+    if (status > 0)
       return E_BUFFER_NOT_FULL;
-    }
 
     result <<= 8;
     result |= b;
@@ -128,20 +210,11 @@ long long ReadUInt(IMkvReader* pReader, long long pos, long& len) {
     ++pos;
   }
 
+  len = length;
   return result;
 }
 
-// Reads an EBML ID and returns it.
-// An ID must at least 1 byte long, cannot exceed 4, and its value must be
-// greater than 0.
-// See known EBML values and EBMLMaxIDLength:
-// http://www.matroska.org/technical/specs/index.html
-// Returns the ID, or a value less than 0 to report an error while reading the
-// ID.
-long long ReadID(IMkvReader* pReader, long long pos, long& len) {
-  if (pReader == NULL || pos < 0)
-    return E_FILE_FORMAT_INVALID;
-
+long long ReadIDBytewise(IMkvReader* pReader, long long pos, long& len) {
   // Read the first byte. The length in bytes of the ID is determined by
   // finding the first set bit in the first byte of the ID.
   unsigned char temp_byte = 0;
@@ -155,26 +228,15 @@ long long ReadID(IMkvReader* pReader, long long pos, long& len) {
   if (temp_byte == 0)  // ID length > 8 bytes; invalid file.
     return E_FILE_FORMAT_INVALID;
 
-  int bit_pos = 0;
-  const int kMaxIdLengthInBytes = 4;
-  const int kCheckByte = 0x80;
+  const long kMaxIdLengthInBytes = 4;
+  const long id_length = VIntLength(temp_byte);
 
-  // Find the first bit that's set.
-  bool found_bit = false;
-  for (; bit_pos < kMaxIdLengthInBytes; ++bit_pos) {
-    if ((kCheckByte >> bit_pos) & temp_byte) {
-      found_bit = true;
-      break;
-    }
-  }
-
-  if (!found_bit) {
+  if (id_length > kMaxIdLengthInBytes) {
     // The value is too large to be a valid ID.
     return E_FILE_FORMAT_INVALID;
   }
 
   // Read the remaining bytes of the ID (if any).
-  const int id_length = bit_pos + 1;
   long long ebml_id = temp_byte;
   for (int i = 1; i < id_length; ++i) {
     ebml_id <<= 8;
@@ -191,6 +253,101 @@ long long ReadID(IMkvReader* pReader, long long pos, long& len) {
   len = id_length;
   return ebml_id;
 }
+}  // namespace
+
+long long DecodeUInt(const unsigned char* buf, long size, long& len) {
+  len = 1;
+
+  if (buf == NULL || size <= 0)
+    return E_BUFFER_NOT_FULL;
+
+  const unsigned char b = buf[0];
+
+  if (b == 0)  // we can't handle u-int values larger than 8 bytes
+    return E_FILE_FORMAT_INVALID;
+
+  const long length = VIntLength(b);
+
+  if (length > size)
+    return E_BUFFER_NOT_FULL;
+
+  long long result = b & (0xFF >> length);
+
+  for (long i = 1; i < length; ++i)
+    result = (result << 8) | buf[i];
+
+  len = length;
+  return result;
+}
+
+long long DecodeID(const unsigned char* buf, long size, long& len) {
+  if (buf == NULL || size <= 0)
+    return E_BUFFER_NOT_FULL;
+
+  const unsigned char b = buf[0];
+
+  if (b == 0)  // ID length > 8 bytes; invalid file.
+    return E_FILE_FORMAT_INVALID;
+
+  const long kMaxIdLengthInBytes = 4;
+  const long id_length = VIntLength(b);
+
+  if (id_length > kMaxIdLengthInBytes)
+    return E_FILE_FORMAT_INVALID;
+
+  if (id_length > size)
+    return E_BUFFER_NOT_FULL;
+
+  long long ebml_id = b;
+
+  for (long i = 1; i < id_length; ++i)
+    ebml_id = (ebml_id << 8) | buf[i];
+
+  len = id_length;
+  return ebml_id;
+}
+
+long long ReadUInt(IMkvReader* pReader, long long pos, long& len) {
+  if (!pReader || pos < 0)
+    return E_FILE_FORMAT_INVALID;
+
+  unsigned char buf[kMaxVIntLength];
+
+  if (!ReadVIntBytes(pReader, pos, buf))
+    return ReadUIntBytewise(pReader, pos, len);
+
+  const long long result = DecodeUInt(buf, kMaxVIntLength, len);
+
+  if (result < 0)
+    len = 1;
+
+  return result;
+}
+
+// Reads an EBML ID and returns it.
+// An ID must at least 1 byte long, cannot exceed 4, and its value must be
+// greater than 0.
+// See known EBML values and EBMLMaxIDLength:
+// http://www.matroska.org/technical/specs/index.html
+// Returns the ID, or a value less than 0 to report an error while reading the
+// ID.
+long long ReadID(IMkvReader* pReader, long long pos, long& len) {
+  if (pReader == NULL || pos < 0)
+    return E_FILE_FORMAT_INVALID;
+
+  unsigned char buf[kMaxVIntLength];
+
+  if (!ReadVIntBytes(pReader, pos, buf))
+    return ReadIDBytewise(pReader, pos, len);
+
+  long id_length;
+  const long long ebml_id = DecodeID(buf, kMaxVIntLength, id_length);
+
+  if (ebml_id >= 0)
+    len = id_length;
+
+  return ebml_id;
+}
 
 long long GetUIntLength(IMkvReader* pReader, long long pos, long& len) {
   if (!pReader || pos < 0)
@@ -217,12 +374,7 @@ long long GetUIntLength(IMkvReader* pReader, long long pos, long& len) {
   if (b == 0)  // we can't handle u-int values larger than 8 bytes
     return E_FILE_FORMAT_INVALID;
 
-  unsigned char m = 0x80;
-
-  while (!(b & m)) {
-    m >>= 1;
-    ++len;
-  }
+  len = VIntLength(b);
 
   return 0;  // success
 }
@@ -698,7 +850,9 @@ Segment::Segment(IMkvReader* pReader, long long elem_start,
       m_clusters(NULL),
       m_clusterCount(0),
       m_clusterPreloadCount(0),
-      m_clusterSize(0) {}
+      m_clusterSize(0),
+      m_track_filter(NULL),
+      m_track_filter_count(0) {}
 
 Segment::~Segment() {
   const long count = m_clusterCount + m_clusterPreloadCount;
@@ -711,8 +865,6 @@ Segment::~Segment() {
     delete p;
   }
 
-  delete[] m_clusters;
-
   delete m_pTracks;
   delete m_pInfo;
   delete m_pCues;
@@ -1009,6 +1161,13 @@ long long Segment::ParseHeaders() {
   if (segment_stop >= 0 && m_pos > segment_stop)
     return E_FILE_FORMAT_INVALID;
 
+  if (m_pSeekHead) {
+    const long status = ParseSeekHeadTargets();
+
+    if (status < 0)
+      return status;
+  }
+
   if (m_pInfo == NULL)  // TODO: liberalize this behavior
     return E_FILE_FORMAT_INVALID;
 
@@ -1342,7 +1501,9 @@ bool Segment::AppendCluster(Cluster* pCluster) {
   if (count >= size) {
     const long n = (size <= 0) ? 2048 : 2 * size;
 
-    Cluster** const qq = new Cluster*[n];
+    Cluster** const qq = m_arena.AllocateArray<Cluster*>(n);
+    if (qq == NULL)
+      return false;
 
     Cluster** q = qq;
     Cluster** p = m_clusters;
@@ -1351,8 +1512,6 @@ bool Segment::AppendCluster(Cluster* pCluster) {
     while (p != pp)
       *q++ = *p++;
 
-    delete[] m_clusters;
-
     m_clusters = qq;
     size = n;
   }
@@ -1397,7 +1556,9 @@ bool Segment::PreloadCluster(Cluster* pCluster, ptrdiff_t idx) {
   if (count >= size) {
     const long n = (size <= 0) ? 2048 : 2 * size;
 
-    Cluster** const qq = new Cluster*[n];
+    Cluster** const qq = m_arena.AllocateArray<Cluster*>(n);
+    if (qq == NULL)
+      return false;
     Cluster** q = qq;
 
     Cluster** p = m_clusters;
@@ -1406,8 +1567,6 @@ bool Segment::PreloadCluster(Cluster* pCluster, ptrdiff_t idx) {
     while (p != pp)
       *q++ = *p++;
 
-    delete[] m_clusters;
-
     m_clusters = qq;
     size = n;
   }
@@ -1598,6 +1757,60 @@ const SeekHead::VoidElement* SeekHead::GetVoidElement(int idx) const {
   return m_void_elements + idx;
 }
 
+// Parses the Info and the Cues which the SeekHead places after the first
+// cluster, e.g. the Cues written at the end of the file by mkvmuxer, without
+// walking the clusters. Cues which are not available yet are left for later.
+long Segment::ParseSeekHeadTargets() {
+  // SeekID values are read as integers, i.e. without the length marker
+  const long long info_id = libwebm::kMkvInfo & 0x0FFFFFFF;
+  const long long cues_id = libwebm::kMkvCues & 0x0FFFFFFF;
+
+  for (int i = 0; i < m_pSeekHead->GetCount(); ++i) {
+    const SeekHead::Entry* const pEntry = m_pSeekHead->GetEntry(i);
+
+    if (pEntry == NULL)
+      return E_PARSE_FAILED;
+
+    if (pEntry->id == cues_id && m_pCues == NULL) {
+      long long pos;
+      long len;
+
+      ParseCues(pEntry->pos, pos, len);  // optional, errors are ignored
+    } else if (pEntry->id == info_id && m_pInfo == NULL) {
+      long long pos = m_start + pEntry->pos;
+      const long long element_start = pos;
+      long len;
+
+      const long long id = ReadID(m_pReader, pos, len);
+
+      if (id != libwebm::kMkvInfo)
+        return E_FILE_FORMAT_INVALID;
+
+      pos += len;  // consume ID
+
+      const long long size = ReadUInt(m_pReader, pos, len);
+
+      if (size < 0)  // error or underflow
+        return static_cast<long>(size);
+
+      pos += len;  // consume size
+
+      if (m_size >= 0 && (pos + size) > (m_start + m_size))
+        return E_FILE_FORMAT_INVALID;
+
+      m_pInfo = new SegmentInfo(this, pos, size, element_start,
+                                pos + size - element_start);
+
+      const long status = m_pInfo->Parse();
+
+      if (status)
+        return status;
+    }
+  }
+
+  return 0;  // success
+}
+
 long Segment::ParseCues(long long off, long long& pos, long& len) {
   if (m_pCues)
     return 0;  // success
@@ -2173,6 +2386,55 @@ const BlockEntry* Segment::GetBlock(const CuePoint& cp,
   return pCluster->GetEntry(cp, tp);
 }
 
+long Segment::SeekWithCues(const Track* pTrack, long long time_ns,
+                           const BlockEntry*& pResult) {
+  pResult = NULL;
+
+  // Clusters are only preloaded within a segment of known size
+  if (pTrack == NULL || m_pCues == NULL || m_size < 0 || time_ns < 0)
+    return -1;
+
+  // Load the cue points lazily, up to the first one after the time
+  for (;;) {
+    const CuePoint* const pLast = m_pCues->GetLast();
+
+    if (pLast && pLast->GetTime(this) > time_ns)
+      break;
+
+    if (!m_pCues->LoadCuePoint())
+      break;
+  }
+
+  const CuePoint* pCP;
+  const CuePoint::TrackPosition* pTP;
+
+  if (!m_pCues->Find(time_ns, pTrack, pCP, pTP))
+    return -1;
+
+  const Cluster* pCluster = FindOrPreloadCluster(pTP->m_pos);
+
+  if (pCluster == NULL || pCluster->EOS())
+    return -1;
+
+  const BlockEntry* pEntry = pCluster->GetEntry(*pCP, *pTP);
+
+  if (pEntry == NULL || pEntry->EOS() || !pTrack->VetEntry(pEntry))
+    return -1;
+
+  // Later blocks at or before the time may follow until the next cue point
+  while (pCluster && !pCluster->EOS() && pCluster->GetTime() <= time_ns) {
+    const BlockEntry* const pLater = pCluster->GetEntry(pTrack, time_ns);
+
+    if (pLater && !pLater->EOS())
+      pEntry = pLater;
+
+    pCluster = GetNext(pCluster);
+  }
+
+  pResult = pEntry;
+  return 0;
+}
+
 const Cluster* Segment::FindOrPreloadCluster(long long requested_pos) {
   if (requested_pos < 0)
     return 0;
@@ -3185,6 +3447,37 @@ const Cluster* Segment::FindCluster(long long time_ns) const {
 const Tracks* Segment::GetTracks() const { return m_pTracks; }
 const SegmentInfo* Segment::GetInfo() const { return m_pInfo; }
 const Cues* Segment::GetCues() const { return m_pCues; }
+
+bool Segment::SetTrackFilter(const long long* track_numbers, long count) {
+  if (count <= 0 || track_numbers == NULL) {
+    m_track_filter_count = 0;
+    return true;
+  }
+
+  // Arrays of previous filters stay in the arena, filters are set rarely
+  long long* const filter = m_arena.AllocateArray<long long>(count);
+  if (filter == NULL)
+    return false;
+
+  for (long i = 0; i < count; ++i)
+    filter[i] = track_numbers[i];
+
+  m_track_filter = filter;
+  m_track_filter_count = count;
+  return true;
+}
+
+bool Segment::IsTrackFiltered(long long track_number) const {
+  if (m_track_filter_count <= 0)
+    return false;
+
+  for (long i = 0; i < m_track_filter_count; ++i) {
+    if (m_track_filter[i] == track_number)
+      return false;
+  }
+
+  return true;
+}
 const Chapters* Segment::GetChapters() const { return m_pChapters; }
 const Tags* Segment::GetTags() const { return m_pTags; }
 const SeekHead* Segment::GetSeekHead() const { return m_pSeekHead; }
@@ -6039,6 +6332,80 @@ long Cluster::Load(long long& pos, long& len) const {
   return 0;
 }
 
+namespace {
+// Reads the track number of a SimpleBlock or of the Block of a BlockGroup,
+// which starts at |pos| and ends at |stop|. Returns 0 with a track number of 0
+// when the element is malformed, so that parsing it reports the error.
+long ReadBlockTrackNumber(IMkvReader* pReader, long long id, long long pos,
+                          long long stop, long long avail, long long& track,
+                          long& len) {
+  track = 0;
+
+  if (id == libwebm::kMkvBlockGroup) {
+    // find the Block
+    for (;;) {
+      if (pos >= stop)
+        return 0;
+
+      if (pos >= avail) {
+        len = 1;
+        return E_BUFFER_NOT_FULL;
+      }
+
+      const long long sub_id = ReadID(pReader, pos, len);
+
+      if (sub_id == E_BUFFER_NOT_FULL)
+        return E_BUFFER_NOT_FULL;
+
+      if (sub_id < 0 || (pos + len) >= stop)
+        return 0;
+
+      pos += len;  // consume ID field
+
+      if (pos >= avail) {
+        len = 1;
+        return E_BUFFER_NOT_FULL;
+      }
+
+      const long long sub_size = ReadUInt(pReader, pos, len);
+
+      if (sub_size == E_BUFFER_NOT_FULL)
+        return E_BUFFER_NOT_FULL;
+
+      if (sub_size < 0 || sub_size > (stop - pos - len))
+        return 0;
+
+      pos += len;  // consume size field
+
+      if (sub_id == libwebm::kMkvBlock) {
+        stop = pos + sub_size;
+        break;
+      }
+
+      pos += sub_size;  // consume sub-part of block group
+    }
+  }
+
+  if (pos >= stop)
+    return 0;
+
+  if (pos >= avail) {
+    len = 1;
+    return E_BUFFER_NOT_FULL;
+  }
+
+  const long long result = ReadUInt(pReader, pos, len);
+
+  if (result == E_BUFFER_NOT_FULL)
+    return E_BUFFER_NOT_FULL;
+
+  if (result > 0 && (pos + len) <= stop)
+    track = result;
+
+  return 0;
+}
+}  // namespace
+
 long Cluster::Parse(long long& pos, long& len) const {
   long status = Load(pos, len);
 
@@ -6182,6 +6549,23 @@ long Cluster::Parse(long long& pos, long& len) const {
 
     Cluster* const this_ = const_cast<Cluster*>(this);
 
+    if (m_pSegment->HasTrackFilter() &&
+        (id == libwebm::kMkvBlockGroup || id == libwebm::kMkvSimpleBlock)) {
+      long long track;
+
+      status = ReadBlockTrackNumber(pReader, id, pos, block_stop, avail,
+                                    track, len);
+
+      if (status < 0)  // error or underflow
+        return status;
+
+      if (track > 0 && m_pSegment->IsTrackFiltered(track)) {
+        pos = block_stop;  // skip block of a deselected track
+        m_pos = pos;
+        continue;
+      }
+    }
+
     if (id == libwebm::kMkvBlockGroup)
       return this_->ParseBlockGroup(size, pos, len);
 
@@ -6575,7 +6959,7 @@ Cluster* Cluster::Create(Segment* pSegment, long idx, long long off) {
 
   const long long element_start = pSegment->m_start + off;
 
-  return new Cluster(pSegment, idx, element_start);
+  return new (pSegment->GetArena()) Cluster(pSegment, idx, element_start);
 }
 
 Cluster::Cluster()
@@ -6616,8 +7000,6 @@ Cluster::~Cluster() {
 
     delete p;
   }
-
-  delete[] m_entries;
 }
 
 bool Cluster::EOS() const { return (m_pSegment == NULL); }
@@ -6918,7 +7300,9 @@ long Cluster::CreateBlock(long long id,
     assert(m_entries_size == 0);
 
     m_entries_size = 1024;
-    m_entries = new BlockEntry*[m_entries_size];
+    m_entries = m_pSegment->GetArena().AllocateArray<BlockEntry*>(m_entries_size);
+    if (m_entries == NULL)
+      return -1;
 
     m_entries_count = 0;
   } else {
@@ -6929,7 +7313,10 @@ long Cluster::CreateBlock(long long id,
     if (m_entries_count >= m_entries_size) {
       const long entries_size = 2 * m_entries_size;
 
-      BlockEntry** const entries = new BlockEntry*[entries_size];
+      BlockEntry** const entries =
+          m_pSegment->GetArena().AllocateArray<BlockEntry*>(entries_size);
+      if (entries == NULL)
+        return -1;
 
       BlockEntry** src = m_entries;
       BlockEntry** const src_end = src + m_entries_count;
@@ -6939,8 +7326,6 @@ long Cluster::CreateBlock(long long id,
       while (src != src_end)
         *dst++ = *src++;
 
-      delete[] m_entries;
-
       m_entries = entries;
       m_entries_size = entries_size;
     }
@@ -7038,7 +7423,11 @@ long Cluster::CreateBlockGroup(long long start_offset, long long size,
   BlockEntry** const ppEntry = m_entries + idx;
   BlockEntry*& pEntry = *ppEntry;
 
-  pEntry = new BlockGroup(this, idx, bpos, bsize, prev, next, duration, discard_padding);
+  pEntry = new (m_pSegment->GetArena())
+      BlockGroup(this, idx, bpos, bsize, prev, next, duration, discard_padding);
+
+  if (pEntry == NULL)
+    return -1;  // generic error
 
   BlockGroup* const p = static_cast<BlockGroup*>(pEntry);
 
@@ -7066,7 +7455,10 @@ long Cluster::CreateSimpleBlock(long long st, long long sz) {
   BlockEntry** const ppEntry = m_entries + idx;
   BlockEntry*& pEntry = *ppEntry;
 
-  pEntry = new SimpleBlock(this, idx, st, sz);
+  pEntry = new (m_pSegment->GetArena()) SimpleBlock(this, idx, st, sz);
+
+  if (pEntry == NULL)
+    return -1;  // generic error
 
   SimpleBlock* const p = static_cast<SimpleBlock*>(pEntry);
 
@@ -7197,11 +7589,13 @@ const BlockEntry* Cluster::GetEntry(const Track* pTrack,
       long len;
 
       const long status = Parse(pos, len);
-      assert(status >= 0);
 
       if (status > 0)  // completely parsed, and no more entries
         return pResult;
 
+      if (status == E_BUFFER_NOT_FULL)  // file still growing, best so far
+        return pResult;
+
       if (status < 0)  // should never happen
         return 0;
 
@@ -7247,7 +7641,9 @@ const BlockEntry* Cluster::GetEntry(const CuePoint& cp,
   assert(m_pSegment);
   const long long tc = cp.GetTimeCode();
 
-  if (tp.m_block > 0) {
+  // Block numbers of the cues count the blocks of all tracks, which are not
+  // all parsed when a track filter is set
+  if (tp.m_block > 0 && !m_pSegment->HasTrackFilter()) {
     const long block = static_cast<long>(tp.m_block);
     const long index = block - 1;
 
@@ -7391,7 +7787,7 @@ Block::Block(long long start, long long size_, long long discard_padding)
       m_frame_count(-1),
       m_discard_padding(discard_padding) {}
 
-Block::~Block() { delete[] m_frames; }
+Block::~Block() {}  // frames belong to the arena of the segment
 
 long Block::Parse(const Cluster* pCluster) {
   if (pCluster == NULL)
@@ -7461,7 +7857,10 @@ long Block::Parse(const Cluster* pCluster) {
       return E_FILE_FORMAT_INVALID;
 
     m_frame_count = 1;
-    m_frames = new Frame[m_frame_count];
+    m_frames = pCluster->m_pSegment->GetArena().AllocateArray<Frame>(1);
+
+    if (m_frames == NULL)
+      return -1;
 
     Frame& f = m_frames[0];
     f.pos = pos;
@@ -7492,7 +7891,8 @@ long Block::Parse(const Cluster* pCluster) {
 
   m_frame_count = int(biased_count) + 1;
 
-  m_frames = new Frame[m_frame_count];
+  m_frames =
+      pCluster->m_pSegment->GetArena().AllocateArray<Frame>(m_frame_count);
 
   if (!m_frames)
     return E_FILE_FORMAT_INVALID;
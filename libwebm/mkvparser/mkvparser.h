@@ -24,12 +24,50 @@ class IMkvReader {
   virtual ~IMkvReader();
 };
 
+// Monotonic allocator for what a segment parses in bulk: clusters, block
+// entries, frame arrays and the arrays indexing them. Deleting these objects
+// only runs their destructors, the memory is released at once together with
+// the segment.
+class Arena {
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+ public:
+  Arena();
+  ~Arena();
+
+  void* Allocate(size_t size);  // NULL when out of memory
+
+  template <typename T>
+  T* AllocateArray(long count) {
+    if (count <= 0 || static_cast<size_t>(count) > size_t(-1) / sizeof(T))
+      return NULL;
+    return static_cast<T*>(Allocate(count * sizeof(T)));
+  }
+
+ private:
+  struct Chunk {
+    Chunk* m_next;
+  };
+
+  Chunk* m_chunks;
+  unsigned char* m_pos;  // free space of the current chunk
+  unsigned char* m_end;
+  size_t m_chunk_size;  // size of the next chunk, grows with use
+};
+
 template <typename Type>
 Type* SafeArrayAlloc(unsigned long long num_elements,
                      unsigned long long element_size);
 long long GetUIntLength(IMkvReader*, long long, long&);
 long long ReadUInt(IMkvReader*, long long, long&);
 long long ReadID(IMkvReader* pReader, long long pos, long& len);
+
+// Decode a variable-length integer or an element ID from |size| bytes already
+// in memory. Same results as ReadUInt and ReadID, with E_BUFFER_NOT_FULL when
+// |buf| ends inside the value.
+long long DecodeUInt(const unsigned char* buf, long size, long& len);
+long long DecodeID(const unsigned char* buf, long size, long& len);
 long long UnserializeUInt(IMkvReader*, long long pos, long long size);
 
 long UnserializeFloat(IMkvReader*, long long pos, long long size, double&);
@@ -78,7 +116,7 @@ class Block {
   Block(long long start, long long size, long long discard_padding);
   ~Block();
 
-  long Parse(const Cluster*);
+  long Parse(const Cluster*);  // frames are allocated from the arena of the segment
 
   long long GetTrackNumber() const;
   long long GetTimeCode(const Cluster*) const;  // absolute, but not scaled
@@ -125,6 +163,13 @@ class BlockEntry {
  public:
   virtual ~BlockEntry();
 
+  // Allocated from the arena of the segment, delete only runs destructors.
+  static void* operator new(size_t size, Arena& arena) throw() {
+    return arena.Allocate(size);
+  }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+
   bool EOS() const { return (GetKind() == kBlockEOS); }
   const Cluster* GetCluster() const;
   long GetIndex() const;
@@ -938,6 +983,13 @@ class Cluster {
   Cluster& operator=(const Cluster&);
 
  public:
+  // Allocated from the arena of the segment, delete only runs destructors.
+  static void* operator new(size_t size, Arena& arena) throw() {
+    return arena.Allocate(size);
+  }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+
   Segment* const m_pSegment;
 
  public:
@@ -1067,6 +1119,23 @@ class Segment {
 
   const Cluster* FindOrPreloadCluster(long long pos);
 
+  // Seeks with the Cues, loading only the cue points up to the requested time
+  // and the clusters from the cued one on. Finds the last block at or before
+  // the time that the track vets, e.g. a keyframe. Returns a negative value
+  // when the Cues cannot be used, e.g. when they do not reference the track.
+  long SeekWithCues(const Track*, long long time_ns,
+                    const BlockEntry*& pResult);
+
+  Arena& GetArena() { return m_arena; }
+
+  // Restricts the parsing of clusters to the blocks of the given tracks.
+  // Blocks of other tracks are skipped by their size, without creating block
+  // entries. Clusters parsed before keep their entries. A count of 0 parses
+  // the blocks of all tracks again.
+  bool SetTrackFilter(const long long* track_numbers, long count);
+  bool HasTrackFilter() const { return m_track_filter_count > 0; }
+  bool IsTrackFiltered(long long track_number) const;  // true when skipped
+
   long ParseCues(long long cues_off,  // offset relative to start of segment
                  long long& parse_pos, long& parse_len);
 
@@ -1084,10 +1153,14 @@ class Segment {
   long m_clusterCount;  // number of entries for which m_index >= 0
   long m_clusterPreloadCount;  // number of entries for which m_index < 0
   long m_clusterSize;  // array size
+  Arena m_arena;  // clusters and everything they parse, released last
+  long long* m_track_filter;  // tracks whose blocks are parsed
+  long m_track_filter_count;
 
   long DoLoadCluster(long long&, long&);
   long DoLoadClusterUnknownSize(long long&, long&);
   long DoParseNext(const Cluster*&, long long&, long&);
+  long ParseSeekHeadTargets();
 
   bool AppendCluster(Cluster*);
   bool PreloadCluster(Cluster*, ptrdiff_t);
@@ -0,0 +1,102 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+#include "FrameCache.hpp"
+
+namespace simplewebm
+{
+	// Set memory budget
+	void FrameCache::set_capacity(const size_t max_bytes)
+	{
+		_max_bytes = max_bytes;
+		evict(_max_bytes);
+	}
+
+	// Find frame shown at time
+	const Image* FrameCache::find(const double time, double& end_time)
+	{
+		if (_max_bytes == 0)
+		{
+			return nullptr;
+		}
+
+		// Latest frame starting at or before time must still be shown at time
+		auto it = _index.upper_bound(time);
+		if (it != _index.begin())
+		{
+			--it;
+			if (time < it->second->end_time)
+			{
+				// Mark as most recently used
+				_entries.splice(_entries.begin(), _entries, it->second);
+				++_stats.hits;
+				end_time = it->second->end_time;
+				return &it->second->image;
+			}
+		}
+		++_stats.misses;
+		return nullptr;
+	}
+
+	// Insert frame
+	void FrameCache::insert(const Image& image, const double end_time)
+	{
+		// Skip frames that do not fit at all or are already cached
+		const size_t bytes = sizeof(Entry) + image.data.size();
+		if (bytes > _max_bytes || _index.count(image.time) > 0)
+		{
+			return;
+		}
+
+		// Make room and insert as most recently used
+		evict(_max_bytes - bytes);
+		Entry entry;
+		entry.image = image;
+		entry.end_time = end_time;
+		entry.bytes = bytes;
+		_entries.push_front(std::move(entry));
+		_index[image.time] = _entries.begin();
+		_stats.resident_bytes += bytes;
+		++_stats.resident_frames;
+	}
+
+	// Get statistics
+	CacheStats FrameCache::get_stats() const
+	{
+		return _stats;
+	}
+
+	// Evict least recently used frames
+	void FrameCache::evict(const size_t max_bytes)
+	{
+		while (!_entries.empty() && _stats.resident_bytes > max_bytes)
+		{
+			const Entry& entry = _entries.back();
+			_stats.resident_bytes -= entry.bytes;
+			--_stats.resident_frames;
+			_index.erase(entry.image.time);
+			_entries.pop_back();
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+#pragma once
+
+#include "../libsimplewebm.hpp"
+#include <list>
+#include <map>
+
+namespace simplewebm
+{
+	// Memory bounded least recently used cache of converted frames
+	class FrameCache
+	{
+	public:
+
+		// Set memory budget in bytes, evicts frames beyond it. Zero disables the cache.
+		void set_capacity(const size_t max_bytes);
+
+		// Find frame shown at time and time until it is shown, returns nullptr when not cached
+		const Image* find(const double time, double& end_time);
+
+		// Insert frame that is shown until the next frame at end_time
+		void insert(const Image& image, const double end_time);
+
+		// Get statistics
+		CacheStats get_stats() const;
+
+	private:
+
+		// Cached frame
+		struct Entry
+		{
+			Image image;
+			double end_time; // time of the following frame
+			size_t bytes;
+		};
+
+		// Evict least recently used frames until budget is met
+		void evict(const size_t max_bytes);
+
+		// Members
+		std::list<Entry> _entries; // most recently used first
+		std::map<double, std::list<Entry>::iterator> _index; // frame time to entry
+		size_t _max_bytes = 0;
+		CacheStats _stats;
+	};
+}
@@ -0,0 +1,155 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+#include "FrameDiff.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMPLE_WEBM_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+
+namespace simplewebm
+{
+	// Function to sum absolute differences of one row
+	static inline unsigned long long row_sad(const unsigned char* p_a, const unsigned char* p_b, const int width)
+	{
+		unsigned long long sum = 0;
+		int j = 0;
+#ifdef SIMPLE_WEBM_SSE2
+		// Sixteen samples at once, psadbw sums each half into a 64 bit lane
+		__m128i acc = _mm_setzero_si128();
+		for (; j + 16 <= width; j += 16)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_a + j));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_b + j));
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+		}
+		sum = (unsigned long long)_mm_cvtsi128_si32(acc) + (unsigned long long)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+		for (; j < width; ++j)
+		{
+			sum += (p_a[j] > p_b[j]) ? (p_a[j] - p_b[j]) : (p_b[j] - p_a[j]);
+		}
+		return sum;
+	}
+
+	// Sum of absolute differences of two planes
+	unsigned long long plane_sad(
+		const unsigned char* p_a,
+		const int a_linesize,
+		const unsigned char* p_b,
+		const int b_linesize,
+		const int width,
+		const int height,
+		const unsigned long long max_sad)
+	{
+		unsigned long long sum = 0;
+		for (int i = 0; i < height && sum <= max_sad; ++i)
+		{
+			sum += row_sad(p_a + (i * a_linesize), p_b + (i * b_linesize), width);
+		}
+		return sum;
+	}
+
+	// Function to tell whether a tile differs in any plane, tiles are rounded outwards on the chroma planes
+	static bool tile_changed(const YUVPlanes& a, const YUVPlanes& b, const int x, const int y, const int width, const int height)
+	{
+		for (int plane = 0; plane < 3; ++plane)
+		{
+			const int shift_w = plane > 0 ? a.chroma_shift_w : 0;
+			const int shift_h = plane > 0 ? a.chroma_shift_h : 0;
+			const int plane_x = x >> shift_w;
+			const int plane_y = y >> shift_h;
+			const int plane_width = ((x + width + (1 << shift_w) - 1) >> shift_w) - plane_x;
+			const int plane_height = ((y + height + (1 << shift_h) - 1) >> shift_h) - plane_y;
+			if (plane_sad(
+				a.p_data[plane] + (plane_y * a.linesize[plane]) + plane_x, a.linesize[plane],
+				b.p_data[plane] + (plane_y * b.linesize[plane]) + plane_x, b.linesize[plane],
+				plane_width, plane_height, 0) > 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Rectangles of the changed tiles
+	void changed_tiles(
+		const YUVPlanes& a,
+		const YUVPlanes& b,
+		const int tile_size,
+		std::vector<Rect>& rects)
+	{
+		rects.clear();
+		const int columns = (a.width + tile_size - 1) / tile_size;
+		const int rows = (a.height + tile_size - 1) / tile_size;
+		std::vector<size_t> open; // rectangles reaching down to the current row
+		std::vector<size_t> next_open;
+		for (int r = 0; r < rows; ++r)
+		{
+			const int y = r * tile_size;
+			const int height = std::min(tile_size, a.height - y);
+			next_open.clear();
+			int run_start = -1;
+			for (int c = 0; c <= columns; ++c)
+			{
+				// Close run of changed tiles at the first unchanged tile or at the end of the row
+				const int x = c * tile_size;
+				const bool changed = c < columns && tile_changed(a, b, x, y, std::min(tile_size, a.width - x), height);
+				if (changed && run_start < 0)
+				{
+					run_start = c;
+				}
+				else if (!changed && run_start >= 0)
+				{
+					Rect rect;
+					rect.x = run_start * tile_size;
+					rect.y = y;
+					rect.width = std::min(x, a.width) - rect.x;
+					rect.height = height;
+					run_start = -1;
+
+					// Extend rectangle of the row above when it spans the same columns
+					const auto it = std::find_if(open.begin(), open.end(), [&](const size_t i)
+					{
+						return rects[i].x == rect.x && rects[i].width == rect.width;
+					});
+					if (it != open.end())
+					{
+						rects[*it].height += height;
+						next_open.push_back(*it);
+					}
+					else
+					{
+						next_open.push_back(rects.size());
+						rects.push_back(rect);
+					}
+				}
+			}
+			open.swap(next_open);
+		}
+	}
+}
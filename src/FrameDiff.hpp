@@ -0,0 +1,64 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+#pragma once
+
+#include "../libsimplewebm.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace simplewebm
+{
+	// Three planes of 8 bit samples, chroma planes are subsampled by the shifts
+	class YUVPlanes
+	{
+	public:
+		const unsigned char* p_data[3];
+		int linesize[3];
+		int width; // of luma plane
+		int height; // of luma plane
+		int chroma_shift_w;
+		int chroma_shift_h;
+	};
+
+	// Sum of absolute differences of two planes of 8 bit samples, uses SSE2 where available.
+	// Stops after the row at which the sum exceeds max_sad, so that differing planes are told apart early.
+	unsigned long long plane_sad(
+		const unsigned char* p_a,
+		const int a_linesize,
+		const unsigned char* p_b,
+		const int b_linesize,
+		const int width,
+		const int height,
+		const unsigned long long max_sad);
+
+	// Rectangles of the tiles of tile_size luma pixels in which any plane of two images of the same size differs.
+	// Changed tiles next to each other in a row form one rectangle, which grows downwards while the rows below change
+	// in the same columns.
+	void changed_tiles(
+		const YUVPlanes& a,
+		const YUVPlanes& b,
+		const int tile_size,
+		std::vector<Rect>& rects);
+}
@@ -0,0 +1,99 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace simplewebm
+{
+	// Constructor
+	ThreadPool::ThreadPool(unsigned int thread_count)
+	{
+		if (thread_count == 0)
+		{
+			thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		for (unsigned int i = 0; i < thread_count; ++i)
+		{
+			_threads.emplace_back(&ThreadPool::work, this);
+		}
+	}
+
+	// Destructor
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_condition.notify_all();
+		for (std::thread& thread : _threads)
+		{
+			thread.join();
+		}
+	}
+
+	// Queue task
+	void ThreadPool::submit(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_tasks.push(std::move(task));
+		}
+		_condition.notify_one();
+	}
+
+	// Count of worker threads
+	unsigned int ThreadPool::get_thread_count() const
+	{
+		return (unsigned int)_threads.size();
+	}
+
+	// Loop of each worker thread
+	void ThreadPool::work()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+				if (_tasks.empty())
+				{
+					return; // stopped and drained
+				}
+				task = std::move(_tasks.front());
+				_tasks.pop();
+			}
+			task();
+		}
+	}
+
+	// Pool shared by the library
+	ThreadPool& get_thread_pool()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+}
@@ -0,0 +1,70 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace simplewebm
+{
+	// Fixed size pool of worker threads executing tasks in order of submission
+	class ThreadPool
+	{
+	public:
+
+		// Constructor, thread_count == 0 will use all cores
+		ThreadPool(unsigned int thread_count = 0);
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool const&) = delete;
+
+		// Destructor, finishes queued tasks
+		~ThreadPool();
+
+		// Queue task for execution
+		void submit(std::function<void()> task);
+
+		// Count of worker threads
+		unsigned int get_thread_count() const;
+
+	private:
+
+		// Loop of each worker thread
+		void work();
+
+		// Members
+		std::vector<std::thread> _threads;
+		std::queue<std::function<void()> > _tasks;
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		bool _stop = false;
+	};
+
+	// Pool shared by the asynchronous functions of the library, created on first use
+	ThreadPool& get_thread_pool();
+}
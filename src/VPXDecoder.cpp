@@ -30,42 +30,278 @@
 #include <stdlib.h>
 #include <string.h>
 
-VPXDecoder::VPXDecoder(const WebMDemuxer &demuxer, unsigned threads) :
+#include <algorithm>
+#include <thread>
+
+/**/
+
+//Boolean entropy decoder of VP8 (RFC 6386, section 7), bytes past the end read as zero
+class VP8BoolReader
+{
+public:
+	VP8BoolReader(const unsigned char *data, size_t size) :
+		m_data(data),
+		m_end(data + size),
+		m_value(0),
+		m_range(255),
+		m_bitCount(0)
+	{
+		m_value = (nextByte() << 8) | nextByte();
+	}
+
+	bool read(unsigned prob)
+	{
+		const unsigned split = 1 + (((m_range - 1) * prob) >> 8);
+		const unsigned bigSplit = split << 8;
+		bool bit;
+		if (m_value >= bigSplit)
+		{
+			m_range -= split;
+			m_value -= bigSplit;
+			bit = true;
+		}
+		else
+		{
+			m_range = split;
+			bit = false;
+		}
+		while (m_range < 128)
+		{
+			m_value <<= 1;
+			m_range <<= 1;
+			if (++m_bitCount == 8)
+			{
+				m_bitCount = 0;
+				m_value |= nextByte();
+			}
+		}
+		return bit;
+	}
+	unsigned literal(int bits)
+	{
+		unsigned value = 0;
+		while (bits-- > 0)
+			value = (value << 1) | read(128);
+		return value;
+	}
+
+private:
+	unsigned nextByte()
+	{
+		return (m_data < m_end) ? *m_data++ : 0;
+	}
+
+	const unsigned char *m_data, *m_end;
+	unsigned m_value, m_range;
+	int m_bitCount;
+};
+
+//Plain big-endian bit reader of the VP9 uncompressed header, fails past the end
+class VP9BitReader
+{
+public:
+	VP9BitReader(const unsigned char *data, size_t size) :
+		m_data(data),
+		m_bits(size * 8),
+		m_pos(0)
+	{}
+
+	inline bool ok() const
+	{
+		return m_pos <= m_bits;
+	}
+	unsigned read(int bits)
+	{
+		unsigned value = 0;
+		while (bits-- > 0)
+		{
+			if (m_pos >= m_bits)
+			{
+				m_pos = m_bits + 1;
+				return 0;
+			}
+			value = (value << 1) | ((m_data[m_pos >> 3] >> (7 - (m_pos & 7))) & 1);
+			++m_pos;
+		}
+		return value;
+	}
+
+private:
+	const unsigned char *m_data;
+	size_t m_bits, m_pos;
+};
+
+static bool peekVP8Header(const unsigned char *data, size_t size, VPXDecoder::FrameHeader &header)
+{
+	//Frame tag (RFC 6386, section 9.1)
+	if (size < 3)
+		return false;
+	const unsigned tag = data[0] | (data[1] << 8) | (data[2] << 16);
+	header.shown = (tag >> 4) & 1;
+	header.reference = true;
+	header.independent = true; //VP8 predicts through the golden, alt-ref and last buffers only
+	if (!(tag & 1))
+		return true; //Key frame
+	const size_t firstPartitionSize = tag >> 5;
+	VP8BoolReader reader(data + 3, std::min(firstPartitionSize, size - 3));
+
+	//Segmentation and loop filter deltas persist into later frames when updated (section 9.3 - 9.6)
+	if (reader.read(128) && (reader.read(128) || reader.read(128)))
+		return true;
+	reader.literal(1 + 6 + 3); //Filter type, level and sharpness
+	if (reader.read(128) && reader.read(128))
+		return true;
+	reader.literal(2); //Partitions
+	reader.literal(7); //Quantizer indices
+	for (int i = 0; i < 5; ++i)
+		if (reader.read(128))
+			reader.literal(4 + 1);
+
+	//Reference buffer updates (section 9.7 - 9.8), probabilities persist unless restored after the frame (section 9.10)
+	const bool refreshGolden = reader.read(128);
+	const bool refreshAltRef = reader.read(128);
+	if (refreshGolden || refreshAltRef)
+		return true;
+	if (reader.literal(2) || reader.literal(2))
+		return true; //Copies into golden or alt-ref buffer
+	reader.literal(2); //Sign bias
+	if (reader.read(128))
+		return true; //Refresh entropy probabilities
+	header.reference = reader.read(128); //Refresh last frame
+	return true;
+}
+
+static bool peekVP9Header(const unsigned char *data, size_t size, VPXDecoder::FrameHeader &header)
+{
+	//Uncompressed header (VP9 bitstream specification, section 6.2)
+	VP9BitReader reader(data, size);
+	if (reader.read(2) != 2)
+		return false;
+	const unsigned profile = reader.read(1) | (reader.read(1) << 1);
+	if (profile == 3)
+		reader.read(1);
+	header.reference = true;
+	header.independent = false;
+	if (reader.read(1))
+	{
+		//Shows an already decoded frame
+		reader.read(3);
+		header.shown = true;
+		header.reference = false;
+		return reader.ok();
+	}
+	const bool keyFrame = !reader.read(1);
+	header.shown = reader.read(1);
+	const bool errorResilient = reader.read(1);
+	if (keyFrame)
+	{
+		header.independent = true;
+		return reader.ok();
+	}
+	const bool intraOnly = header.shown ? false : reader.read(1);
+	const unsigned resetFrameContext = errorResilient ? 0 : reader.read(2);
+	header.independent = intraOnly || errorResilient;
+	if (intraOnly || errorResilient)
+		return reader.ok(); //Resets probabilities, loop filter deltas and segmentation for later frames
+	if (reader.read(8) || resetFrameContext >= 2)
+		return reader.ok(); //Refreshes reference buffers or resets probabilities
+
+	//References and frame size, later frames compare their size against an explicit one
+	reader.read(3 * 4);
+	bool foundRef = false;
+	for (int i = 0; i < 3 && !foundRef; ++i)
+		foundRef = reader.read(1);
+	if (!foundRef)
+		return reader.ok();
+	if (reader.read(1))
+		reader.read(32); //Render size
+	reader.read(1); //High precision motion vectors
+	if (!reader.read(1))
+		reader.read(2); //Interpolation filter
+
+	//Probabilities, loop filter deltas and segmentation persist into later frames when updated
+	if (reader.read(1))
+		return reader.ok();
+	reader.read(1 + 2); //Frame parallel mode and frame context
+	reader.read(6 + 3);
+	if (reader.read(1) && reader.read(1))
+		return reader.ok();
+	reader.read(8);
+	for (int i = 0; i < 3; ++i)
+		if (reader.read(1))
+			reader.read(5);
+	if (reader.read(1) && (reader.read(1) || reader.read(1)))
+		return reader.ok(); //Segmentation map or data update
+	header.reference = false;
+	return reader.ok();
+}
+
+/**/
+
+static unsigned maxTileColumns(int width)
+{
+	//VP9 tiles are at least 4 superblocks (256 pixels) wide and at most 64 per frame
+	const int sb64Cols = (width + 63) >> 6;
+	int log2 = 0;
+	while (log2 < 6 && (sb64Cols >> (log2 + 1)) >= 4)
+		++log2;
+	return 1u << log2;
+}
+
+VPXDecoder::VPXDecoder(const WebMDemuxer &demuxer, unsigned threads, THREADING threading) :
+	VPXDecoder(demuxer.getVideoCodec(), (demuxer.getVideoCodec() != WebMDemuxer::NO_VIDEO) ? demuxer.getWidth() : 0, threads, threading)
+{}
+VPXDecoder::VPXDecoder(WebMDemuxer::VIDEO_CODEC codec, int width, unsigned threads, THREADING threading) :
 	m_ctx(NULL),
 	m_iter(NULL),
-	m_delay(0)
+	m_serial(0),
+	m_delay(0),
+	m_threads(0),
+	m_codec(codec)
 {
-	if (threads > 8)
-		threads = 8;
-	else if (threads < 1)
-		threads = 1;
+	if (threads < 1)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
 
-	const vpx_codec_dec_cfg_t codecCfg = {
-		threads,
-		0,
-		0
-	};
 	vpx_codec_iface_t *codecIface = NULL;
+	bool frameThreading = false;
 
-	switch (demuxer.getVideoCodec())
+	switch (codec)
 	{
 		case WebMDemuxer::VIDEO_VP8:
 			codecIface = vpx_codec_vp8_dx();
 			break;
 		case WebMDemuxer::VIDEO_VP9:
 			codecIface = vpx_codec_vp9_dx();
-			m_delay = threads - 1;
+			if (threads > 1 && (vpx_codec_get_caps(codecIface) & VPX_CODEC_CAP_FRAME_THREADING))
+			{
+				if (threading == THREADING_FRAME)
+					frameThreading = true;
+				else if (threading == THREADING_AUTO)
+					frameThreading = threads > maxTileColumns(width);
+			}
 			break;
 		default:
 			return;
 	}
 
+	if (frameThreading)
+		m_delay = threads - 1;
+
+	const vpx_codec_dec_cfg_t codecCfg = {
+		threads,
+		0,
+		0
+	};
+
 	m_ctx = new vpx_codec_ctx_t;
-	if (vpx_codec_dec_init(m_ctx, codecIface, &codecCfg, m_delay > 0 ? VPX_CODEC_USE_FRAME_THREADING : 0))
+	if (vpx_codec_dec_init(m_ctx, codecIface, &codecCfg, frameThreading ? VPX_CODEC_USE_FRAME_THREADING : 0))
 	{
 		delete m_ctx;
 		m_ctx = NULL;
+		m_delay = 0;
+		return;
 	}
+	m_threads = threads;
 }
 VPXDecoder::~VPXDecoder()
 {
@@ -76,10 +312,93 @@ VPXDecoder::~VPXDecoder()
 	}
 }
 
+bool VPXDecoder::peekHeader(const WebMFrame &frame, FrameHeader &header) const
+{
+	switch (m_codec)
+	{
+		case WebMDemuxer::VIDEO_VP8:
+			return peekVP8Header(frame.getData(), frame.bufferSize, header);
+		case WebMDemuxer::VIDEO_VP9:
+		{
+			const unsigned char *data = frame.getData();
+			const size_t size = frame.bufferSize;
+			if (size < 1)
+				return false;
+
+			//A superframe index at the end lists the sizes of the frames packed into the block
+			const unsigned char marker = data[size - 1];
+			if ((marker & 0xE0) == 0xC0)
+			{
+				const unsigned frames = (marker & 0x7) + 1;
+				const unsigned mag = ((marker >> 3) & 0x3) + 1;
+				const size_t indexSize = 2 + mag * frames;
+				if (size >= indexSize && data[size - indexSize] == marker)
+				{
+					const unsigned char *index = data + size - indexSize + 1;
+					size_t offset = 0;
+					for (unsigned i = 0; i < frames; ++i)
+					{
+						size_t frameSize = 0;
+						for (unsigned b = 0; b < mag; ++b)
+							frameSize |= (size_t)index[i * mag + b] << (b * 8);
+						if (offset + frameSize > size - indexSize)
+							return false;
+
+						//The block is shown when any frame is and a reference when any frame is. Only the first
+						//frame predicts from the frame decoded before the block.
+						FrameHeader frameHeader;
+						if (!peekVP9Header(data + offset, frameSize, frameHeader))
+							return false;
+						if (i == 0)
+							header = frameHeader;
+						else
+						{
+							header.shown |= frameHeader.shown;
+							header.reference |= frameHeader.reference;
+						}
+						offset += frameSize;
+					}
+					return true;
+				}
+			}
+			return peekVP9Header(data, size, header);
+		}
+		default:
+			return false;
+	}
+}
 bool VPXDecoder::decode(const WebMFrame &frame)
 {
 	m_iter = NULL;
-	return !vpx_codec_decode(m_ctx, frame.buffer, frame.bufferSize, NULL, 0);
+
+	//The serial travels through the decoder as user_priv, so each image can be paired with its input time
+	//even when frame threading delays it or a hidden frame (e.g. VP8 alt-ref) produces no image at all
+	const PendingFrame pending = { ++m_serial, frame.time };
+	m_pending.push_back(pending);
+	return !vpx_codec_decode(m_ctx, frame.getData(), frame.bufferSize, (void *)(size_t)pending.serial, 0);
+}
+bool VPXDecoder::flush()
+{
+	m_iter = NULL;
+	return !vpx_codec_decode(m_ctx, NULL, 0, NULL, 0);
+}
+void VPXDecoder::reset()
+{
+	if (m_ctx && !m_pending.empty())
+	{
+		flush();
+		while (vpx_codec_get_frame(m_ctx, &m_iter))
+			;
+	}
+	m_pending.clear();
+	m_iter = NULL;
+}
+bool VPXDecoder::getPendingTime(double &time) const
+{
+	if (m_pending.empty())
+		return false;
+	time = m_pending.front().time;
+	return true;
 }
 VPXDecoder::IMAGE_ERROR VPXDecoder::getImage(Image &image)
 {
@@ -106,17 +425,32 @@ VPXDecoder::IMAGE_ERROR VPXDecoder::getImage(Image &image)
 				image.linesize[1] = img->stride[uPlane];
 				image.linesize[2] = img->stride[vPlane];
 
+				image.time = popTime((size_t)img->user_priv);
+
 				err = NO_ERROR;
 			}
 		}
 		else
 		{
+			image.time = popTime((size_t)img->user_priv);
 			err = UNSUPPORTED_FRAME;
 		}
 	}
 	return err;
 }
 
+double VPXDecoder::popTime(unsigned long serial)
+{
+	//Frames older than the returned one will never produce an image
+	while (!m_pending.empty() && m_pending.front().serial != serial)
+		m_pending.pop_front();
+	if (m_pending.empty())
+		return 0.0;
+	const double time = m_pending.front().time;
+	m_pending.pop_front();
+	return time;
+}
+
 /**/
 
 static inline int ceilRshift(int val, int shift)
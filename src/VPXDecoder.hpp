@@ -27,6 +27,8 @@
 
 #include "WebMDemuxer.hpp"
 
+#include <deque>
+
 struct vpx_codec_ctx;
 
 class VPXDecoder
@@ -44,6 +46,15 @@ public:
 		int chromaShiftW, chromaShiftH;
 		unsigned char *planes[3];
 		int linesize[3];
+		double time; //Time of the WebMFrame this image was decoded from
+	};
+
+	class FrameHeader
+	{
+	public:
+		bool shown; //The frame produces an image
+		bool reference; //Later frames depend on it through reference buffers, probabilities or other decoder state
+		bool independent; //Does not predict from the previously decoded frame beyond the reference buffers
 	};
 
 	enum IMAGE_ERROR
@@ -53,7 +64,15 @@ public:
 		NO_FRAME
 	};
 
-	VPXDecoder(const WebMDemuxer &demuxer, unsigned threads = 1);
+	enum THREADING
+	{
+		THREADING_AUTO, //Tile threading while the tile columns can keep all threads busy, frame threading otherwise
+		THREADING_TILE, //Low latency, parallelism limited by the tile columns of the stream
+		THREADING_FRAME //High throughput, adds (threads - 1) frames of latency (VP9 only)
+	};
+
+	VPXDecoder(const WebMDemuxer &demuxer, unsigned threads = 1, THREADING threading = THREADING_AUTO); //threads == 0 uses all cores
+	VPXDecoder(WebMDemuxer::VIDEO_CODEC codec, int width, unsigned threads = 1, THREADING threading = THREADING_AUTO); //For any video track of the demuxer
 	~VPXDecoder();
 
 	inline bool isOpen() const
@@ -65,14 +84,34 @@ public:
 	{
 		return m_delay;
 	}
+	inline unsigned getThreads() const
+	{
+		return m_threads;
+	}
 
+	bool peekHeader(const WebMFrame &frame, FrameHeader &header) const; //Reads the uncompressed frame headers without decoding, false if they cannot be read
 	bool decode(const WebMFrame &frame);
+	bool flush(); //Call at end of stream, then fetch the delayed images with getImage() until NO_FRAME
+	void reset(); //Drop all delayed images, e.g. after seeking. Decoding must continue with a keyframe.
+	bool getPendingTime(double &time) const; //Time of the oldest frame passed to decode() which did not produce an image yet
 	IMAGE_ERROR getImage(Image &image); //The data is NOT copied! Only 3-plane, 8-bit images are supported.
 
 private:
+	double popTime(unsigned long serial);
+
+	struct PendingFrame
+	{
+		unsigned long serial;
+		double time;
+	};
+
 	vpx_codec_ctx *m_ctx;
 	const void *m_iter;
+	std::deque<PendingFrame> m_pending; //Frames passed to the decoder which did not produce an image yet
+	unsigned long m_serial;
 	int m_delay;
+	unsigned m_threads;
+	WebMDemuxer::VIDEO_CODEC m_codec;
 };
 
 #endif // VPXDECODER_HPP
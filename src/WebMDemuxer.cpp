@@ -32,9 +32,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <utility>
+
 WebMFrame::WebMFrame() :
 	bufferSize(0), bufferCapacity(0),
 	buffer(NULL),
+	borrowed(NULL),
 	time(0),
 	key(false)
 {}
@@ -45,24 +49,31 @@ WebMFrame::~WebMFrame()
 
 /**/
 
-WebMDemuxer::WebMDemuxer(mkvparser::IMkvReader *reader, int videoTrack, int audioTrack) :
+WebMDemuxer::WebMDemuxer(mkvparser::IMkvReader *reader, int videoTrack, int audioTrack, const std::function<bool()> &waitForData) :
 	m_reader(reader),
+	m_directReader(dynamic_cast<const WebMDirectReader *>(reader)),
 	m_segment(NULL),
 	m_cluster(NULL), m_block(NULL), m_blockEntry(NULL),
 	m_blockFrameIndex(0),
 	m_videoTrack(NULL), m_vCodec(NO_VIDEO),
 	m_audioTrack(NULL), m_aCodec(NO_AUDIO),
 	m_isOpen(false),
-	m_eos(false)
+	m_eos(false),
+	m_parseVideo(true), m_parseAudio(true),
+	m_waitForData(waitForData),
+	m_length(-1.0)
 {
-	long long pos = 0;
-	if (mkvparser::EBMLHeader().Parse(m_reader, pos))
+	long long pos = 0, status = 0;
+	while ((status = mkvparser::EBMLHeader().Parse(m_reader, pos = 0)) && waitOnUnderflow(status, true));
+	if (status)
 		return;
 
-	if (mkvparser::Segment::CreateInstance(m_reader, pos, m_segment))
+	while ((status = mkvparser::Segment::CreateInstance(m_reader, pos, m_segment)) && waitOnUnderflow(status, true));
+	if (status)
 		return;
 
-	if (m_segment->Load() < 0)
+	while ((status = m_segment->ParseHeaders()) && waitOnUnderflow(status, true));
+	if (status || !m_segment->GetInfo() || !m_segment->GetTracks())
 		return;
 
 	const mkvparser::Tracks *tracks = m_segment->GetTracks();
@@ -73,6 +84,8 @@ WebMDemuxer::WebMDemuxer(mkvparser::IMkvReader *reader, int videoTrack, int audi
 		const mkvparser::Track *track = tracks->GetTrackByIndex(i);
 		if (const char *codecId = track->GetCodecId())
 		{
+			if (track->GetType() == mkvparser::Track::kVideo && (!strcmp(codecId, "V_VP8") || !strcmp(codecId, "V_VP9")))
+				m_videoTracks.push_back(static_cast<const mkvparser::VideoTrack *>(track));
 			if ((!m_videoTrack || currVideoTrack != videoTrack) && track->GetType() == mkvparser::Track::kVideo)
 			{
 				if (!strcmp(codecId, "V_VP8"))
@@ -98,23 +111,87 @@ WebMDemuxer::WebMDemuxer(mkvparser::IMkvReader *reader, int videoTrack, int audi
 	if (!m_videoTrack && !m_audioTrack)
 		return;
 
+	//Clusters of unknown size are parsed while loading, so the blocks of tracks which can be read are kept from the start
+	std::vector<long long> trackNumbers;
+	for (size_t i = 0; i < m_videoTracks.size(); ++i)
+		trackNumbers.push_back(m_videoTracks[i]->GetNumber());
+	if (m_audioTrack)
+		trackNumbers.push_back(m_audioTrack->GetNumber());
+	if (!m_segment->SetTrackFilter(trackNumbers.data(), (long)trackNumbers.size()))
+		return;
+
+	//A file being written is loaded cluster by cluster while reading, as is a file which can be seeked with its Cues
+	if (!m_waitForData && !m_segment->GetCues() && !loadAllClusters())
+		return;
+
 	m_isOpen = true;
 }
 WebMDemuxer::~WebMDemuxer()
 {
+	clearQueues();
+	for (size_t i = 0; i < m_spareFrames.size(); ++i)
+		delete m_spareFrames[i];
 	delete m_segment;
 	delete m_reader;
 }
 
 double WebMDemuxer::getLength() const
 {
-	return m_segment->GetDuration() / 1e9;
+	if (m_length < 0.0 || m_waitForData) //Length of a file being written keeps growing
+	{
+		const long long duration = m_segment->GetDuration();
+		double endTime = 0.0, frameInterval = 0.0;
+		if (duration >= 0)
+			m_length = duration / 1e9;
+		else if (m_videoTrack && estimateEnd(m_reader, m_segment, m_videoTrack->GetNumber(), endTime, frameInterval))
+			m_length = endTime + (m_videoTrack->GetDefaultDuration() ? m_videoTrack->GetDefaultDuration() / 1e9 : frameInterval);
+		else if (m_audioTrack && estimateEnd(m_reader, m_segment, m_audioTrack->GetNumber(), endTime, frameInterval))
+			m_length = endTime + frameInterval;
+		else
+			m_length = 0.0;
+	}
+	return m_length;
+}
+
+long WebMDemuxer::getVideoTrackNumber() const
+{
+	return m_videoTrack ? (long)m_videoTrack->GetNumber() : 0;
+}
+double WebMDemuxer::getTimeScale() const
+{
+	return m_segment->GetInfo()->GetTimeCodeScale() / 1e9;
+}
+
+long WebMDemuxer::getAudioTrackNumber() const
+{
+	return m_audioTrack ? (long)m_audioTrack->GetNumber() : 0;
 }
 
 WebMDemuxer::VIDEO_CODEC WebMDemuxer::getVideoCodec() const
 {
 	return m_vCodec;
 }
+
+int WebMDemuxer::getVideoTrackCount() const
+{
+	return (int)m_videoTracks.size();
+}
+long WebMDemuxer::getVideoTrackNumber(int index) const
+{
+	return (long)m_videoTracks[index]->GetNumber();
+}
+WebMDemuxer::VIDEO_CODEC WebMDemuxer::getVideoTrackCodec(int index) const
+{
+	return strcmp(m_videoTracks[index]->GetCodecId(), "V_VP9") ? VIDEO_VP8 : VIDEO_VP9;
+}
+int WebMDemuxer::getVideoTrackWidth(int index) const
+{
+	return (int)m_videoTracks[index]->GetWidth();
+}
+int WebMDemuxer::getVideoTrackHeight(int index) const
+{
+	return (int)m_videoTracks[index]->GetHeight();
+}
 int WebMDemuxer::getWidth() const
 {
 	return (int)m_videoTrack->GetWidth();
@@ -144,12 +221,19 @@ int WebMDemuxer::getAudioDepth() const
 {
 	return (int)m_audioTrack->GetBitDepth();
 }
+double WebMDemuxer::getSeekPreRoll() const
+{
+	return m_audioTrack->GetSeekPreRoll() / 1e9;
+}
+double WebMDemuxer::getCodecDelay() const
+{
+	return m_audioTrack->GetCodecDelay() / 1e9;
+}
 
 bool WebMDemuxer::readFrame(WebMFrame *videoFrame, WebMFrame *audioFrame)
 {
 	const long videoTrackNumber = (videoFrame && m_videoTrack) ? m_videoTrack->GetNumber() : 0;
 	const long audioTrackNumber = (audioFrame && m_audioTrack) ? m_audioTrack->GetNumber() : 0;
-	bool blockEntryEOS = false;
 
 	if (videoFrame)
 		videoFrame->bufferSize = 0;
@@ -159,11 +243,179 @@ bool WebMDemuxer::readFrame(WebMFrame *videoFrame, WebMFrame *audioFrame)
 	if (videoTrackNumber == 0 && audioTrackNumber == 0)
 		return false;
 
+	if (!nextBlock(videoTrackNumber, audioTrackNumber))
+		return false;
+
+	WebMFrame *frame = NULL;
+
+	const long trackNumber = (long)m_block->GetTrackNumber();
+	if (trackNumber == videoTrackNumber)
+		frame = videoFrame;
+	else if (trackNumber == audioTrackNumber)
+		frame = audioFrame;
+	else
+	{
+		//Should not be possible
+		assert(trackNumber == videoTrackNumber || trackNumber == audioTrackNumber);
+		return false;
+	}
+
+	return readBlockFrame(frame);
+}
+
+void WebMDemuxer::parseTracks(bool video, bool audio)
+{
+	m_parseVideo = video;
+	m_parseAudio = audio;
+	updateTrackFilter();
+}
+
+bool WebMDemuxer::enableTrack(long trackNumber)
+{
+	if (!m_segment->GetTracks()->GetTrackByNumber(trackNumber))
+		return false;
+	m_queues[trackNumber];
+	updateTrackFilter();
+	return true;
+}
+void WebMDemuxer::disableTrack(long trackNumber)
+{
+	std::map<long, std::deque<WebMFrame *> >::iterator queue = m_queues.find(trackNumber);
+	if (queue == m_queues.end())
+		return;
+	m_spareFrames.insert(m_spareFrames.end(), queue->second.begin(), queue->second.end());
+	m_queues.erase(queue);
+	updateTrackFilter();
+}
+
+bool WebMDemuxer::readTrackFrame(long trackNumber, WebMFrame *frame)
+{
+	frame->bufferSize = 0;
+
+	std::map<long, std::deque<WebMFrame *> >::iterator queue = m_queues.find(trackNumber);
+	if (queue == m_queues.end())
+		return false;
+
+	//Packets queued while reading for other tracks come first, their buffers are swapped instead of copied
+	if (!queue->second.empty())
+	{
+		WebMFrame *queued = queue->second.front();
+		queue->second.pop_front();
+		std::swap(frame->buffer, queued->buffer);
+		std::swap(frame->bufferCapacity, queued->bufferCapacity);
+		frame->bufferSize = queued->bufferSize;
+		frame->borrowed = queued->borrowed;
+		frame->time = queued->time;
+		frame->key = queued->key;
+		queued->bufferSize = 0;
+		m_spareFrames.push_back(queued);
+		return true;
+	}
+
+	//Read blocks of all enabled tracks in file order, so that every cluster is read once
+	while (nextBlock(ENABLED_TRACKS, 0))
+	{
+		const long blockTrackNumber = (long)m_block->GetTrackNumber();
+		if (blockTrackNumber == trackNumber)
+			return readBlockFrame(frame);
+
+		WebMFrame *queued = NULL;
+		if (m_spareFrames.empty())
+			queued = new WebMFrame;
+		else
+		{
+			queued = m_spareFrames.back();
+			m_spareFrames.pop_back();
+		}
+		if (!readBlockFrame(queued))
+		{
+			m_spareFrames.push_back(queued);
+			return false;
+		}
+		m_queues[blockTrackNumber].push_back(queued);
+	}
+	return false;
+}
+
+bool WebMDemuxer::peekVideoTime(double &time)
+{
+	if (!m_videoTrack)
+		return false;
+
+	//A video packet queued for the multi-track reader is next
+	std::map<long, std::deque<WebMFrame *> >::const_iterator queue = m_queues.find(m_videoTrack->GetNumber());
+	if (queue != m_queues.end() && !queue->second.empty())
+	{
+		time = queue->second.front()->time;
+		return true;
+	}
+
+	const mkvparser::Cluster *cluster = m_cluster;
+	const mkvparser::Block *block = m_block;
+	const mkvparser::BlockEntry *blockEntry = m_blockEntry;
+	const int blockFrameIndex = m_blockFrameIndex;
+	const bool eos = m_eos;
+
+	const bool ok = nextBlock(m_videoTrack->GetNumber(), 0, false);
+	if (ok)
+		time = m_block->GetTime(m_cluster) / 1e9;
+
+	m_cluster = cluster;
+	m_block = block;
+	m_blockEntry = blockEntry;
+	m_blockFrameIndex = blockFrameIndex;
+	m_eos = eos;
+
+	return ok;
+}
+
+bool WebMDemuxer::getVideoKeyFrameTime(double time, double &keyTime) const
+{
+	const mkvparser::BlockEntry *blockEntry = findVideoKeyFrame(time);
+	if (!blockEntry)
+		return false;
+	keyTime = blockEntry->GetBlock()->GetTime(blockEntry->GetCluster()) / 1e9;
+	return true;
+}
+bool WebMDemuxer::seekVideo(double time)
+{
+	const mkvparser::BlockEntry *blockEntry = findVideoKeyFrame(time);
+	if (!blockEntry)
+		return false;
+
+	seekBlockEntry(blockEntry);
+	return true;
+}
+bool WebMDemuxer::seekAudio(double time)
+{
+	if (!m_audioTrack)
+		return false;
+
+	const mkvparser::BlockEntry *blockEntry = findBlock(m_audioTrack, time);
+	if (!blockEntry)
+		return false;
+
+	seekBlockEntry(blockEntry);
+	return true;
+}
+
+bool WebMDemuxer::nextBlock(long videoTrackNumber, long audioTrackNumber, bool wait)
+{
+	bool blockEntryEOS = false;
+
 	if (m_eos)
 		return false;
 
 	if (!m_cluster)
+	{
 		m_cluster = m_segment->GetFirst();
+		if (m_cluster->EOS())
+		{
+			if (!loadCluster(wait))
+				return false;
+			m_cluster = m_segment->GetFirst();
+		}
+	}
 
 	do
 	{
@@ -171,24 +423,42 @@ bool WebMDemuxer::readFrame(WebMFrame *videoFrame, WebMFrame *audioFrame)
 		long status = 0;
 		if (!m_blockEntry && !blockEntryEOS)
 		{
-			status = m_cluster->GetFirst(m_blockEntry);
+			while ((status = m_cluster->GetFirst(m_blockEntry)) && waitOnUnderflow(status, wait));
 			getNewBlock = true;
+			if (!status && !m_blockEntry) //Empty cluster, e.g. when all its blocks belong to tracks not parsed
+			{
+				blockEntryEOS = true;
+				continue;
+			}
 		}
 		else if (blockEntryEOS || m_blockEntry->EOS())
 		{
-			m_cluster = m_segment->GetNext(m_cluster);
-			if (!m_cluster || m_cluster->EOS())
+			const mkvparser::Cluster *cluster = m_segment->GetNext(m_cluster);
+			if (cluster && cluster->EOS() && loadCluster(wait))
+				cluster = m_segment->GetNext(m_cluster);
+			if (!cluster || cluster->EOS())
 			{
-				m_eos = true;
+				//More clusters may follow in a file being written when waiting was not allowed
+				m_eos = !m_waitForData || wait;
 				return false;
 			}
-			status = m_cluster->GetFirst(m_blockEntry);
+			m_cluster = cluster;
+			while ((status = m_cluster->GetFirst(m_blockEntry)) && waitOnUnderflow(status, wait));
 			blockEntryEOS = false;
 			getNewBlock = true;
+			if (!status && !m_blockEntry)
+			{
+				blockEntryEOS = true;
+				continue;
+			}
 		}
 		else if (!m_block || m_blockFrameIndex == m_block->GetFrameCount() || notSupportedTrackNumber(videoTrackNumber, audioTrackNumber))
 		{
-			status = m_cluster->GetNext(m_blockEntry, m_blockEntry);
+			const mkvparser::BlockEntry *blockEntry = m_blockEntry;
+			while ((status = m_cluster->GetNext(m_blockEntry, blockEntry)) && waitOnUnderflow(status, wait));
+			if (status)
+				return false;
+			m_blockEntry = blockEntry;
 			if (!m_blockEntry  || m_blockEntry->EOS())
 			{
 				blockEntryEOS = true;
@@ -205,21 +475,34 @@ bool WebMDemuxer::readFrame(WebMFrame *videoFrame, WebMFrame *audioFrame)
 		}
 	} while (blockEntryEOS || notSupportedTrackNumber(videoTrackNumber, audioTrackNumber));
 
-	WebMFrame *frame = NULL;
+	return true;
+}
 
-	const long trackNumber = (long)m_block->GetTrackNumber();
-	if (trackNumber == videoTrackNumber)
-		frame = videoFrame;
-	else if (trackNumber == audioTrackNumber)
-		frame = audioFrame;
-	else
+void WebMDemuxer::seekBlockEntry(const mkvparser::BlockEntry *blockEntry)
+{
+	clearQueues();
+
+	m_cluster = blockEntry->GetCluster();
+	m_blockEntry = blockEntry;
+	m_block = blockEntry->GetBlock();
+	m_blockFrameIndex = 0;
+	m_eos = false;
+}
+
+bool WebMDemuxer::readBlockFrame(WebMFrame *frame)
+{
+	const mkvparser::Block::Frame &blockFrame = m_block->GetFrame(m_blockFrameIndex++);
+
+	frame->time = m_block->GetTime(m_cluster) / 1e9;
+	frame->key  = m_block->IsKey();
+
+	//Readers holding the file in memory lend the payload, so that it is not copied
+	if (m_directReader && (frame->borrowed = m_directReader->getPointer(blockFrame.pos, blockFrame.len)))
 	{
-		//Should not be possible
-		assert(trackNumber == videoTrackNumber || trackNumber == audioTrackNumber);
-		return false;
+		frame->bufferSize = blockFrame.len;
+		return true;
 	}
 
-	const mkvparser::Block::Frame &blockFrame = m_block->GetFrame(m_blockFrameIndex++);
 	if (blockFrame.len > frame->bufferCapacity)
 	{
 		unsigned char *newBuff = (unsigned char *)realloc(frame->buffer, frame->bufferCapacity = blockFrame.len);
@@ -230,14 +513,221 @@ bool WebMDemuxer::readFrame(WebMFrame *videoFrame, WebMFrame *audioFrame)
 	}
 	frame->bufferSize = blockFrame.len;
 
-	frame->time = m_block->GetTime(m_cluster) / 1e9;
-	frame->key  = m_block->IsKey();
+	//Payload of a block may not be written completely yet
+	long status = 0;
+	while ((status = blockFrame.Read(m_reader, frame->buffer)) > 0 && waitOnUnderflow(status, true));
+	return !status;
+}
+
+void WebMDemuxer::clearQueues()
+{
+	for (std::map<long, std::deque<WebMFrame *> >::iterator queue = m_queues.begin(); queue != m_queues.end(); ++queue)
+	{
+		m_spareFrames.insert(m_spareFrames.end(), queue->second.begin(), queue->second.end());
+		queue->second.clear();
+	}
+}
+
+bool WebMDemuxer::loadAllClusters() const
+{
+	long status = 0;
+	while ((status = m_segment->LoadCluster()) == 0);
+	return status > 0;
+}
+
+bool WebMDemuxer::loadCluster(bool wait)
+{
+	long long pos = 0;
+	long len = 0;
+	long status = 0;
+	while ((status = m_segment->LoadCluster(pos, len)) < 0 && waitOnUnderflow(status, wait));
+	return status == 0;
+}
+
+inline bool WebMDemuxer::waitOnUnderflow(long long status, bool wait) const
+{
+	//Parsers report missing data as E_BUFFER_NOT_FULL or as the positive position they need to read up to
+	return wait && m_waitForData && (status > 0 || status == mkvparser::E_BUFFER_NOT_FULL) && m_waitForData();
+}
+
+const mkvparser::BlockEntry *WebMDemuxer::findVideoKeyFrame(double time) const
+{
+	return m_videoTrack ? findBlock(m_videoTrack, time) : NULL;
+}
+
+const mkvparser::BlockEntry *WebMDemuxer::findBlock(const mkvparser::Track *track, double time) const
+{
+	const long long timeNs = (long long)(std::max(time, 0.0) * 1e9);
+	const mkvparser::BlockEntry *blockEntry = NULL;
+
+	//Cues lead to the cluster without loading the clusters before it
+	if (m_segment->SeekWithCues(track, timeNs, blockEntry) == 0)
+		return blockEntry;
+
+	//Otherwise the track searches all clusters
+	if (!m_waitForData && !loadAllClusters())
+		return NULL;
+	if (track->Seek(timeNs, blockEntry) < 0 || !blockEntry || blockEntry->EOS())
+		return NULL;
+
+	return blockEntry;
+}
+
+/**/
+
+//Read EBML variable length integer from buffer, returns its length or 0 when it does not fit
+static int readVint(const unsigned char *data, const unsigned char *end, unsigned long long &value, bool keepMarker)
+{
+	if (data >= end || !*data)
+		return 0;
+	int len = 1;
+	while (!(*data & (0x80 >> (len - 1))))
+		++len;
+	if (data + len > end)
+		return 0;
+	value = keepMarker ? *data : (*data & (0xFF >> len));
+	for (int i = 1; i < len; ++i)
+		value = (value << 8) | data[i];
+	return len;
+}
+
+//Parse the cluster starting at data, collects time range of the blocks of one track
+static bool parseTailCluster(const unsigned char *data, const unsigned char *end, long trackNumber, long long &firstTime, long long &lastTime, long &blockCount)
+{
+	unsigned long long id = 0, size = 0;
+	int len = readVint(data, end, id, true);
+	if (!len || id != 0x1F43B675)
+		return false;
+	data += len;
+	if (!(len = readVint(data, end, size, false)))
+		return false;
+	const bool unknownSize = (size == (1ULL << (7 * len)) - 1);
+	data += len;
+	if (!unknownSize && size < (unsigned long long)(end - data))
+		end = data + size;
+
+	//The cluster timecode must come first, it validates the ID found while scanning
+	if (!(len = readVint(data, end, id, true)) || id != 0xE7)
+		return false;
+	data += len;
+	if (!(len = readVint(data, end, size, false)) || size > 8 || data + len + size > end)
+		return false;
+	data += len;
+	long long clusterTime = 0;
+	for (unsigned long long i = 0; i < size; ++i)
+		clusterTime = (clusterTime << 8) | *data++;
+
+	//Blocks until the end of the cluster, of the buffer or of a truncated element
+	blockCount = 0;
+	while (data < end)
+	{
+		if (!(len = readVint(data, end, id, true)) || len > 2)
+			break; //Next top level element
+		data += len;
+		if (!(len = readVint(data, end, size, false)) || size > (unsigned long long)(end - data - len))
+			break;
+		data += len;
+		const unsigned char *block = NULL;
+		if (id == 0xA3) //SimpleBlock
+			block = data;
+		else if (id == 0xA0) //BlockGroup, find its Block
+		{
+			const unsigned char *child = data, *childEnd = data + size;
+			unsigned long long childId = 0, childSize = 0;
+			int childLen = 0;
+			while (!block && (childLen = readVint(child, childEnd, childId, true)))
+			{
+				child += childLen;
+				if (!(childLen = readVint(child, childEnd, childSize, false)) || childSize > (unsigned long long)(childEnd - child - childLen))
+					break;
+				child += childLen;
+				if (childId == 0xA1)
+					block = child;
+				child += childSize;
+			}
+		}
+		if (block)
+		{
+			unsigned long long blockTrack = 0;
+			const int trackLen = readVint(block, data + size, blockTrack, false);
+			if (trackLen && block + trackLen + 2 <= data + size && (long)blockTrack == trackNumber)
+			{
+				const long long time = clusterTime + (short)((block[trackLen] << 8) | block[trackLen + 1]);
+				if (!blockCount || time < firstTime)
+					firstTime = time;
+				if (!blockCount || time > lastTime)
+					lastTime = time;
+				++blockCount;
+			}
+		}
+		data += size;
+	}
+	return true;
+}
+
+bool WebMDemuxer::estimateEnd(mkvparser::IMkvReader *reader, const mkvparser::Segment *segment, long trackNumber, double &endTime, double &frameInterval)
+{
+	long long total = 0, available = 0;
+	if (reader->Length(&total, &available) < 0 || available <= segment->m_start)
+		return false;
+	const long long stop = (segment->m_size >= 0) ? std::min(segment->m_start + segment->m_size, available) : available;
+	const double timeScale = segment->GetInfo()->GetTimeCodeScale() / 1e9;
+
+	//Read growing windows from the end until a cluster with blocks of the track is found
+	for (long long window = 64 * 1024; ; window *= 4)
+	{
+		const long long start = std::max(stop - window, segment->m_start);
+		unsigned char *buffer = (unsigned char *)malloc((size_t)(stop - start));
+		if (!buffer)
+			return false;
+		if (reader->Read(start, (long)(stop - start), buffer))
+		{
+			free(buffer);
+			return false;
+		}
+
+		//Resynchronise on cluster IDs, latest first
+		const unsigned char *end = buffer + (stop - start);
+		for (const unsigned char *p = end - 4; p >= buffer; --p)
+		{
+			long long firstTime = 0, lastTime = 0;
+			long blockCount = 0;
+			if (p[0] == 0x1F && p[1] == 0x43 && p[2] == 0xB6 && p[3] == 0x75 && parseTailCluster(p, end, trackNumber, firstTime, lastTime, blockCount) && blockCount > 0)
+			{
+				endTime = lastTime * timeScale;
+				frameInterval = (blockCount > 1) ? (lastTime - firstTime) * timeScale / (blockCount - 1) : 0.0;
+				free(buffer);
+				return true;
+			}
+		}
+		free(buffer);
+
+		if (start == segment->m_start || window >= 16 * 1024 * 1024)
+			return false;
+	}
+}
+
+void WebMDemuxer::updateTrackFilter()
+{
+	std::vector<long long> trackNumbers;
+	if (m_parseVideo && m_videoTrack)
+		trackNumbers.push_back(m_videoTrack->GetNumber());
+	if (m_parseAudio && m_audioTrack)
+		trackNumbers.push_back(m_audioTrack->GetNumber());
+	for (std::map<long, std::deque<WebMFrame *> >::const_iterator queue = m_queues.begin(); queue != m_queues.end(); ++queue)
+		if (std::find(trackNumbers.begin(), trackNumbers.end(), queue->first) == trackNumbers.end())
+			trackNumbers.push_back(queue->first);
 
-	return !blockFrame.Read(m_reader, frame->buffer);
+	//Nothing to parse still needs a filter, an empty one parses every track
+	if (trackNumbers.empty())
+		trackNumbers.push_back(0);
+	m_segment->SetTrackFilter(trackNumbers.data(), (long)trackNumbers.size());
 }
 
 inline bool WebMDemuxer::notSupportedTrackNumber(long videoTrackNumber, long audioTrackNumber) const
 {
 	const long trackNumber = (long)m_block->GetTrackNumber();
+	if (videoTrackNumber == ENABLED_TRACKS)
+		return m_queues.find(trackNumber) == m_queues.end();
 	return (trackNumber != videoTrackNumber && trackNumber != audioTrackNumber);
 }
@@ -27,16 +27,31 @@
 
 #include <stddef.h>
 
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
 namespace mkvparser {
 	class IMkvReader;
 	class Segment;
 	class Cluster;
 	class Block;
 	class BlockEntry;
+	class Track;
 	class VideoTrack;
 	class AudioTrack;
 }
 
+//Optional interface of readers holding the whole file in memory, e.g. memory mapped or loaded by the caller.
+//Frames borrow their payload from such readers instead of copying it.
+class WebMDirectReader
+{
+public:
+	virtual ~WebMDirectReader() {}
+	virtual const unsigned char *getPointer(long long pos, long len) const = 0; //NULL when the range is not available
+};
+
 class WebMFrame
 {
 	WebMFrame(const WebMFrame &);
@@ -49,9 +64,14 @@ public:
 	{
 		return bufferSize > 0;
 	}
+	inline const unsigned char *getData() const //Payload of bufferSize bytes
+	{
+		return borrowed ? borrowed : buffer;
+	}
 
 	long bufferSize, bufferCapacity;
 	unsigned char *buffer;
+	const unsigned char *borrowed; //Payload in memory of a WebMDirectReader, used instead of buffer when set
 	double time;
 	bool key;
 };
@@ -74,7 +94,9 @@ public:
 		AUDIO_OPUS
 	};
 
-	WebMDemuxer(mkvparser::IMkvReader *reader, int videoTrack = 0, int audioTrack = 0);
+	//With waitForData the file may still be written: clusters are loaded while reading and running out of data calls waitForData,
+	//which returns true once the reader has more data available or false to end the stream
+	WebMDemuxer(mkvparser::IMkvReader *reader, int videoTrack = 0, int audioTrack = 0, const std::function<bool()> &waitForData = std::function<bool()>());
 	~WebMDemuxer();
 
 	inline bool isOpen() const
@@ -86,24 +108,71 @@ public:
 		return m_eos;
 	}
 
-	double getLength() const;
+	double getLength() const; //Estimated from the end of the file when the Duration element is missing
+	double getTimeScale() const; //Seconds per timecode unit, the precision of frame times
 
 	VIDEO_CODEC getVideoCodec() const;
 	int getWidth() const;
 	int getHeight() const;
 
+	//All supported video tracks in file order, e.g. for decoding several cameras with readTrackFrame()
+	int getVideoTrackCount() const;
+	long getVideoTrackNumber(int index) const;
+	VIDEO_CODEC getVideoTrackCodec(int index) const;
+	int getVideoTrackWidth(int index) const;
+	int getVideoTrackHeight(int index) const;
+
 	AUDIO_CODEC getAudioCodec() const;
 	const unsigned char *getAudioExtradata(size_t &size) const; // Needed for Vorbis
 	double getSampleRate() const;
 	int getChannels() const;
 	int getAudioDepth() const;
+	double getSeekPreRoll() const;
+	double getCodecDelay() const;
 
 	bool readFrame(WebMFrame *videoFrame, WebMFrame *audioFrame);
 
+	//Blocks of tracks which are not read are skipped while parsing clusters, without allocating entries for them.
+	//By default the selected video and audio track are parsed, tracks enabled below are parsed in addition.
+	//Clusters parsed before keep the blocks of the previous selection, so select before reading.
+	void parseTracks(bool video, bool audio);
+
+	//Single pass demuxing of several tracks: every enabled track gets a packet queue, reading a packet of one track
+	//queues the packets of other enabled tracks found on the way. Disable tracks which are not consumed, their queues grow.
+	//Do not mix with readFrame(), seekVideo() drops all queued packets.
+	bool enableTrack(long trackNumber);
+	void disableTrack(long trackNumber);
+	bool readTrackFrame(long trackNumber, WebMFrame *frame);
+
+	long getVideoTrackNumber() const;
+	long getAudioTrackNumber() const;
+	bool peekVideoTime(double &time); //Time of the video frame the next readFrame() would return
+
+	bool getVideoKeyFrameTime(double time, double &keyTime) const; //Time of the video keyframe at or before the given time
+	bool seekVideo(double time); //Next readFrame() starts at the video keyframe at or before the given time
+	bool seekAudio(double time); //Next readFrame() starts at the first audio block of the cluster at or before the given time
+
+	//Read the last cluster of the segment from the end of the file to get the end time of a track and its average frame interval.
+	//Needs a few KB of I/O instead of parsing the whole file, meant for files without Duration element (e.g. live recordings).
+	static bool estimateEnd(mkvparser::IMkvReader *reader, const mkvparser::Segment *segment, long trackNumber, double &endTime, double &frameInterval);
+
 private:
+	enum { ENABLED_TRACKS = -1 }; //Track number passed to nextBlock() to visit blocks of all enabled tracks
+
+	bool nextBlock(long videoTrackNumber, long audioTrackNumber, bool wait = true);
+	bool readBlockFrame(WebMFrame *frame);
+	void clearQueues();
+	bool loadCluster(bool wait);
+	bool loadAllClusters() const;
+	inline bool waitOnUnderflow(long long status, bool wait) const;
+	const mkvparser::BlockEntry *findVideoKeyFrame(double time) const;
+	const mkvparser::BlockEntry *findBlock(const mkvparser::Track *track, double time) const; //Keyframe of video tracks
+	void seekBlockEntry(const mkvparser::BlockEntry *blockEntry);
 	inline bool notSupportedTrackNumber(long videoTrackNumber, long audioTrackNumber) const;
+	void updateTrackFilter();
 
 	mkvparser::IMkvReader *m_reader;
+	const WebMDirectReader *m_directReader; //Same reader when it lends payloads, NULL otherwise
 	mkvparser::Segment *m_segment;
 
 	const mkvparser::Cluster *m_cluster;
@@ -115,11 +184,22 @@ private:
 	const mkvparser::VideoTrack *m_videoTrack;
 	VIDEO_CODEC m_vCodec;
 
+	std::vector<const mkvparser::VideoTrack *> m_videoTracks;
+
 	const mkvparser::AudioTrack *m_audioTrack;
 	AUDIO_CODEC m_aCodec;
 
 	bool m_isOpen;
 	bool m_eos;
+
+	bool m_parseVideo, m_parseAudio;
+
+	std::function<bool()> m_waitForData;
+
+	std::map<long, std::deque<WebMFrame *> > m_queues; //Packets of enabled tracks, by track number
+	std::vector<WebMFrame *> m_spareFrames; //Recycled packets, keeping their buffers
+
+	mutable double m_length; //Cached result of getLength(), negative until computed
 };
 
 #endif // WEBMDEMUXER_HPP
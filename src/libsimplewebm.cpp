@@ -26,10 +26,19 @@
 
 #include "../libsimplewebm.hpp"
 #include "VPXDecoder.hpp"
+#include "FrameCache.hpp"
+#include "FrameDiff.hpp"
+#include "ThreadPool.hpp"
 #include "mkvparser/mkvparser.h"
+#include "common/webmids.h"
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <thread>
 
 namespace simplewebm
 {
@@ -37,25 +46,72 @@ namespace simplewebm
 	/// Helpers
 	/////////////////////////////////////////////////
 
+	// Seek and tell with 64 bit offsets, so that files beyond 2 GB can be read
+#ifdef _MSC_VER
+	inline int seek64(FILE* file, long long pos) { return _fseeki64(file, pos, SEEK_SET); }
+	inline long long size64(FILE* file) { _fseeki64(file, 0, SEEK_END); return _ftelli64(file); }
+#else
+	inline int seek64(FILE* file, long long pos) { return fseeko(file, (off_t)pos, SEEK_SET); }
+	inline long long size64(FILE* file) { fseeko(file, 0, SEEK_END); return (long long)ftello(file); }
+#endif
+
 	// Class to read file
 	class MkvReader : public mkvparser::IMkvReader
 	{
 	public:
-		MkvReader(const char *filePath) :
-			m_file(fopen(filePath, "rb"))
-		{}
+		MkvReader(const char *filePath, bool follow = false) :
+			m_file(fopen(filePath, "rb")),
+			m_pos(0),
+			m_length(0),
+			m_follow(follow)
+		{
+			// Length of file is fixed while reading, so it is asked once. Followed files are asked again by refresh().
+			if (m_file)
+			{
+				m_length = size64(m_file);
+				m_pos = -1;
+			}
+		}
 		~MkvReader()
 		{
 			if (m_file)
 				fclose(m_file);
 		}
 
+		bool isOpen() const
+		{
+			return m_file != NULL;
+		}
+
+		// Update length of a followed file, returns true when it has grown
+		bool refresh()
+		{
+			if (!m_file)
+				return false;
+			const long long length = size64(m_file);
+			m_pos = -1;
+			clearerr(m_file);
+			if (length <= m_length)
+				return false;
+			m_length = length;
+			return true;
+		}
+
 		int Read(long long pos, long len, unsigned char *buf)
 		{
 			if (!m_file)
 				return -1;
-			fseek(m_file, pos, SEEK_SET);
+			// Data beyond the end of a followed file is not written yet
+			if (m_follow && pos + len > m_length)
+				return 1;
+			// Sequential reads continue in the buffer of the stream without seeking
+			if (pos != m_pos && seek64(m_file, pos))
+			{
+				m_pos = -1;
+				return -1;
+			}
 			const size_t size = fread(buf, 1, len, m_file);
+			m_pos = pos + size;
 			if (size < size_t(len))
 				return -1;
 			return 0;
@@ -64,26 +120,233 @@ namespace simplewebm
 		{
 			if (!m_file)
 				return -1;
-			const off_t pos = ftell(m_file);
-			fseek(m_file, 0, SEEK_END);
 			if (total)
-				*total = ftell(m_file);
+				*total = m_follow ? -1 : m_length; // total length of a followed file is unknown
 			if (available)
-				*available = ftell(m_file);
-			fseek(m_file, pos, SEEK_SET);
+				*available = m_length;
 			return 0;
 		}
 
 	private:
 		FILE * m_file;
+		long long m_pos; // position of the stream, -1 when unknown
+		long long m_length;
+		bool m_follow; // whether file is still being written
+	};
+
+	// Class to read file held in memory by the caller, lends frame payloads to the decoder instead of copying them
+	class MemoryReader : public mkvparser::IMkvReader, public WebMDirectReader
+	{
+	public:
+		MemoryReader(const unsigned char *data, size_t size) :
+			m_data(data),
+			m_size((long long)size)
+		{}
+
+		int Read(long long pos, long len, unsigned char *buf)
+		{
+			const unsigned char *data = getPointer(pos, len);
+			if (!data)
+				return -1;
+			memcpy(buf, data, len);
+			return 0;
+		}
+		int Length(long long *total, long long *available)
+		{
+			if (total)
+				*total = m_size;
+			if (available)
+				*available = m_size;
+			return 0;
+		}
+		const unsigned char *getPointer(long long pos, long len) const
+		{
+			if (!m_data || pos < 0 || len < 0 || pos + len > m_size)
+				return NULL;
+			return m_data + pos;
+		}
+
+	private:
+		const unsigned char *m_data;
+		long long m_size;
 	};
 
+	// Function to find offset of top level element relative to segment in SeekHead, returns -1 when not referenced
+	inline long long find_seek_entry(const mkvparser::Segment& segment, const long long id)
+	{
+		if (const mkvparser::SeekHead* p_seek_head = segment.GetSeekHead())
+		{
+			for (int i = 0; i < p_seek_head->GetCount(); ++i)
+			{
+				// SeekID is read as an EBML integer, i.e. without the length marker of the element ID
+				const mkvparser::SeekHead::Entry* p_entry = p_seek_head->GetEntry(i);
+				if (p_entry->id == (id & 0x0FFFFFFF))
+				{
+					return p_entry->pos;
+				}
+			}
+		}
+		return -1;
+	}
+
+	// Function to map thread count of the factories onto decoder, negative counts fall back to the default of one thread
+	inline unsigned to_vpx_threads(const int thread_count)
+	{
+		return thread_count < 0 ? 1u : (unsigned)thread_count;
+	}
+
+	// Function to map threading policy onto decoder
+	inline VPXDecoder::THREADING to_vpx_threading(Threading threading)
+	{
+		switch (threading)
+		{
+		case Threading::TILE:
+			return VPXDecoder::THREADING_TILE;
+		case Threading::FRAME:
+			return VPXDecoder::THREADING_FRAME;
+		default:
+			return VPXDecoder::THREADING_AUTO;
+		}
+	}
+
 	// Function to clamp int within range of char
 	inline int clamp8(int v)
 	{
 		return std::min(std::max(v, 0), 255);
 	}
 
+	// Function to convert YUV color of a pixel into BGR
+	inline void yuv_to_bgr(const int y, const int u, const int v, char* p_bgr)
+	{
+		const int c = y - 16;
+		const int d = u - 128;
+		const int e = v - 128;
+		p_bgr[0] = clamp8((298 * c + 516 * d + 128) >> 8);
+		p_bgr[1] = clamp8((298 * c - 100 * d - 208 * e + 128) >> 8);
+		p_bgr[2] = clamp8((298 * c + 409 * e + 128) >> 8);
+	}
+
+	// Function to convert decoded image into BGR output image, images of unsupported format are delivered without pixels
+	static Status convert_image(const VPXDecoder::Image& vpx_image, const bool vpx_image_valid, Image& output_image)
+	{
+		// Keep time of the decoded video frame
+		output_image.time = vpx_image.time;
+
+		// Frames in unsupported format are delivered without pixels
+		if (!vpx_image_valid)
+		{
+			return Status::OK;
+		}
+
+		// Get dimensions of the planes
+		const int y_width = vpx_image.getWidth(0);
+		const int y_height = vpx_image.getHeight(0);
+		const int y_linesize = vpx_image.linesize[0];
+		const int u_width = vpx_image.getWidth(1);
+		const int u_height = vpx_image.getHeight(1);
+		const int u_linesize = vpx_image.linesize[1];
+		const int v_width = vpx_image.getWidth(2);
+		const int v_height = vpx_image.getHeight(2);
+		const int v_linesize = vpx_image.linesize[2];
+
+		// Check, whether dimensions are even
+		if (y_width % 2 != 0 || y_height % 2 != 0)
+		{
+			return Status::ERR_ODD_DIMENSION;
+		}
+
+		// Calculate sample of u and v
+		const int u_steps_w = y_width / u_width;
+		const int u_steps_h = y_height / u_height;
+		const int v_steps_w = y_width / v_width;
+		const int v_steps_h = y_height / v_height;
+
+		// Push back new image into output
+		output_image.width = y_width;
+		output_image.height = y_height;
+		output_image.data.reserve(y_width * y_height * 3); // RGB
+
+		// Iterate over y plane
+		for (int i = 0; i < y_height; ++i)
+		{
+			for (int j = 0; j < y_width; ++j)
+			{
+				// Calculate index for u and v
+				const int u_i = i / u_steps_h;
+				const int u_j = j / u_steps_w;
+				const int v_i = i / v_steps_h;
+				const int v_j = j / v_steps_w;
+
+				// Extract YUV color of pixel
+				const int y = *(vpx_image.planes[0] + (i * y_linesize) + j);
+				const int u = *(vpx_image.planes[1] + (u_i * u_linesize) + u_j);
+				const int v = *(vpx_image.planes[2] + (v_i * v_linesize) + v_j);
+
+				// Convert YUV to BGR
+				char bgr[3];
+				yuv_to_bgr(y, u, v, bgr);
+
+				// Set pixel value with BGR format
+				output_image.data.insert(output_image.data.end(), bgr, bgr + 3);
+			}
+		}
+
+		return Status::OK;
+	}
+
+	// Function to convert a rectangle of decoded image into the BGR output image of the same size, which holds its pixels already
+	static void convert_rect(const VPXDecoder::Image& vpx_image, const Rect& rect, Image& output_image)
+	{
+		// Calculate sample of u and v
+		const int u_steps_w = vpx_image.getWidth(0) / vpx_image.getWidth(1);
+		const int u_steps_h = vpx_image.getHeight(0) / vpx_image.getHeight(1);
+		const int v_steps_w = vpx_image.getWidth(0) / vpx_image.getWidth(2);
+		const int v_steps_h = vpx_image.getHeight(0) / vpx_image.getHeight(2);
+
+		// Iterate over rectangle of y plane
+		for (int i = rect.y; i < rect.y + rect.height; ++i)
+		{
+			char* p_bgr = output_image.data.data() + (((size_t)i * output_image.width + rect.x) * 3);
+			for (int j = rect.x; j < rect.x + rect.width; ++j, p_bgr += 3)
+			{
+				const int y = *(vpx_image.planes[0] + (i * vpx_image.linesize[0]) + j);
+				const int u = *(vpx_image.planes[1] + ((i / u_steps_h) * vpx_image.linesize[1]) + (j / u_steps_w));
+				const int v = *(vpx_image.planes[2] + ((i / v_steps_h) * vpx_image.linesize[2]) + (j / v_steps_w));
+				yuv_to_bgr(y, u, v, p_bgr);
+			}
+		}
+	}
+
+	// Function to copy the planes of decoded image into packed rows of data, as the decoder reuses its buffers
+	static YUVPlanes pack_planes(const VPXDecoder::Image& vpx_image, std::vector<unsigned char>& data)
+	{
+		size_t size = 0;
+		for (int plane = 0; plane < 3; ++plane)
+		{
+			size += (size_t)vpx_image.getWidth(plane) * vpx_image.getHeight(plane);
+		}
+		data.resize(size);
+
+		YUVPlanes planes;
+		unsigned char* p_data = data.data();
+		for (int plane = 0; plane < 3; ++plane)
+		{
+			const int plane_width = vpx_image.getWidth(plane);
+			planes.p_data[plane] = p_data;
+			planes.linesize[plane] = plane_width;
+			for (int i = 0; i < vpx_image.getHeight(plane); ++i)
+			{
+				std::memcpy(p_data, vpx_image.planes[plane] + (i * vpx_image.linesize[plane]), plane_width);
+				p_data += plane_width;
+			}
+		}
+		planes.width = vpx_image.getWidth(0);
+		planes.height = vpx_image.getHeight(0);
+		planes.chroma_shift_w = vpx_image.chromaShiftW;
+		planes.chroma_shift_h = vpx_image.chromaShiftH;
+		return planes;
+	}
+
 	/////////////////////////////////////////////////
 	/// VideoWalkerImpl Declaration
 	/////////////////////////////////////////////////
@@ -94,7 +357,8 @@ namespace simplewebm
 	public:
 
 		// Constructor
-		VideoWalkerImpl(const std::string webm_filepath, const int thread_count);
+		VideoWalkerImpl(const std::string webm_filepath, const int thread_count, const Threading threading, const FollowOptions& follow);
+		VideoWalkerImpl(mkvparser::IMkvReader* p_reader, const int thread_count, const Threading threading);
 		VideoWalkerImpl(const VideoWalker&) = delete;
 		VideoWalkerImpl& operator=(VideoWalker const&) = delete;
 
@@ -107,169 +371,350 @@ namespace simplewebm
 			const unsigned int count_to_extract = 0,
 			unsigned int * p_extracted_count = nullptr);
 
+		// Walk over video into sink
+		virtual Status walk(
+			const FrameSink& sink,
+			const unsigned int count_to_extract = 0,
+			unsigned int * p_extracted_count = nullptr);
+
+		// Walk over time range into sink
+		virtual Status walk_range(
+			const double from,
+			const double to,
+			const FrameSink& sink,
+			unsigned int * p_extracted_count = nullptr);
+
+		// Walk over selected frames into sink
+		virtual Status walk_sampled(
+			const SamplingOptions& options,
+			const FrameSink& sink,
+			unsigned int * p_extracted_count = nullptr);
+
+		// Walk over video at a constant frame rate into sink
+		virtual Status walk_cfr(
+			const double fps,
+			const TickSink& sink,
+			unsigned int * p_tick_count = nullptr);
+
+		// Walk over video at a constant frame rate into vector
+		virtual Status walk_cfr(
+			const double fps,
+			std::shared_ptr<std::vector<std::shared_ptr<const Image> > > sp_ticks,
+			unsigned int * p_tick_count = nullptr);
+
+		// Walk over changed regions into canvas
+		virtual Status walk_changes(
+			Image& canvas,
+			const ChangeSink& sink,
+			const int tile_size = 64,
+			unsigned int * p_extracted_count = nullptr);
+
+		// Walk over video asynchronously
+		virtual std::future<Status> walk_async(
+			const FrameSink& sink,
+			const AsyncOptions& options = AsyncOptions());
+
+		// Lazy range over frames
+		virtual FrameRange frames(const FrameRangeOptions& options = FrameRangeOptions());
+
 		// Dry walk
 		virtual Status dry_walk(
 			std::shared_ptr<std::vector<double> > sp_times,
 			const unsigned int count_to_extract = 0,
 			unsigned int * p_extracted_count = nullptr);
 
+		// Get frame at time
+		virtual Status get_frame_at(const double time, Image& image);
+
+		// Get frames at times
+		virtual Status get_frames_at(
+			const std::vector<double>& times,
+			std::shared_ptr<std::vector<Image> > sp_images);
+
+		// Set frame cache budget
+		virtual void set_frame_cache(const size_t max_bytes);
+
+		// Get frame cache statistics
+		virtual CacheStats get_frame_cache_stats() const;
+
+		// Set duplicate detection
+		virtual void set_duplicate_detection(const DuplicateOptions& options);
+
 	private:
 
+		// Source of lazy frame ranges uses the decoding steps below
+		friend class WalkerFrameSource;
+
+		// Walk over video into sink while interrupt returns OK
+		Status walk_sink(
+			const FrameSink& sink,
+			const unsigned int count_to_extract,
+			unsigned int * p_extracted_count,
+			const std::function<Status()>& interrupt);
+
+		// Decode until the decoder emits the next image, return false when video is exhausted
+		bool decode_next();
+
+		// Decode until the next image that walks deliver, skipping suppressed duplicates
+		bool decode_next_unique();
+
+		// Compare the current decoded image with the last image that was not a duplicate
+		void detect_duplicate();
+
+		// Read next video frame into the frame to decode, the frame read ahead comes first
+		bool read_next();
+
+		// Whether the frame to decode is dropped, as it will not be output and no later frame depends on it
+		bool drop_next();
+
+		// Decode the image shown at time, seeking only when time is not ahead within the current group of pictures.
+		// Provides time until which the image is shown.
+		bool decode_at(const double time, double& end_time);
+
+		// Get frame at time through the frame cache
+		Status fetch_at(const double time, Image& image);
+
+		// Decode up to the frame that random access last served from the cache, so that walking continues after it
+		void sync_position();
+
+		// Time of the frame following the current decoded image, return false at end of video
+		bool next_time(double& time);
+
+		// Seek to keyframe at or before time and reset decoding state
+		bool seek(const double time);
+
+		// Seek when time lies beyond the current group of pictures, so decoding forward reaches it soonest
+		bool skip_to(const double time);
+
+		// Convert the current decoded image into BGR output image
+		Status convert(Image& output_image) const;
+
+		// Wait until the followed file grows, return false once idle for too long or interrupted
+		bool wait_for_data();
+
+		// Create decoder once demuxer has been created
+		void open_decoder(const int thread_count, const Threading threading);
+
 		// Members
 		std::unique_ptr<WebMDemuxer> _up_webm_demuxer = nullptr; // splits video and audio
 		std::unique_ptr<WebMFrame> _up_webm_frame = nullptr; // holds encoded video frame
+		std::unique_ptr<WebMFrame> _up_held_frame = nullptr; // holds encoded video frame read ahead of the current one
 		std::unique_ptr<VPXDecoder> _up_vpx_decoder = nullptr; // decods video frame
 		VPXDecoder::Image _vpx_image; // decoded video frame
+		Image _sink_image; // frame handed to sinks, recycled between frames
+		FrameCache _frame_cache; // converted frames of random access
+		bool _vpx_image_valid = false; // whether decoded video frame has supported format
+		bool _draining = false; // whether end of stream has been reached and decoder is drained
+		bool _flushed = false; // whether decoder has been flushed without emitting an image since
+		bool _has_image = false; // whether decoded video frame holds an image of the current position
+		bool _held = false; // whether a video frame has been read ahead
+		double _last_end_time = 0.0; // time until which the frame of the last random access is shown
+		bool _position_pending = false; // whether the last random access was served from the cache without decoding
+		double _pending_time = 0.0; // time of the last random access served from the cache
+		FollowOptions _follow; // how to wait for a file that is still being written
+		MkvReader* _p_reader = nullptr; // reader of the file, owned by demuxer
+		const std::function<Status()>* _p_interrupt = nullptr; // interrupt of the running walk, also ends waiting
+		const std::function<bool(double, bool)>* _p_unselected = nullptr; // whether the frame read at time, shown or not, will not be output
+		DuplicateOptions _duplicates; // how to detect duplicate frames
+		bool _duplicate = false; // whether decoded video frame duplicates the reference planes
+		bool _has_reference = false; // whether reference planes hold the last image that was not a duplicate
+		std::vector<unsigned char> _reference_data; // planes of the last image that was not a duplicate, packed rows
+		YUVPlanes _reference = YUVPlanes(); // points into reference data
 	};
 
 	/////////////////////////////////////////////////
-	/// VideoWalker factory definition
+	/// WalkerFrameSource
 	/////////////////////////////////////////////////
 
-	// Factory of video walkers
-	std::unique_ptr<VideoWalker> create_video_walker(const std::string webm_filepath, const int thread_count)
+	// Source of lazy frame ranges over a video walker
+	class WalkerFrameSource : public FrameSource
 	{
-		return std::unique_ptr<VideoWalker>(new VideoWalkerImpl(webm_filepath, thread_count));
-	}
+	public:
 
-	/////////////////////////////////////////////////
-	/// VideoWalkerImpl Definition
-	/////////////////////////////////////////////////
+		// Constructor
+		WalkerFrameSource(VideoWalkerImpl& walker, const FrameRangeOptions& options) :
+			_walker(walker), _options(options)
+		{
+			_options.stride = std::max(_options.stride, 1u);
+		}
 
-	// Constructor of base class
-	VideoWalker::VideoWalker()
-	{
-		// Do nothing
-	}
+		// Decode next selected frame
+		virtual bool advance()
+		{
+			_converted = false;
+			if (!_walker._up_webm_demuxer || _status != Status::OK || (_options.take > 0 && _taken >= _options.take))
+			{
+				return false;
+			}
 
-	// Destructor of base class
-	VideoWalker::~VideoWalker()
-	{
-		// Do nothing
-	}
+			// Jump close to start of range first
+			if (!_started)
+			{
+				_started = true;
+				_walker.sync_position();
+				_walker.skip_to(_options.from);
+			}
 
-	// Constructor
-	VideoWalkerImpl::VideoWalkerImpl(const std::string webm_filepath, const int thread_count) : VideoWalker()
-	{
-		// Create WebMDemuxer while opening video file
-		_up_webm_demuxer = std::unique_ptr<WebMDemuxer>(new WebMDemuxer(new MkvReader(webm_filepath.c_str())));
+			// Decode frames until one is selected
+			while (_walker.decode_next_unique())
+			{
+				const double time = _walker._vpx_image.time;
+				if (time > _options.to)
+				{
+					return false;
+				}
+				if (time >= _options.from && (_index++ % _options.stride) == 0)
+				{
+					++_taken;
+					return true;
+				}
+			}
+			_status = Status::DONE;
+			return false;
+		}
 
-		// Continue when demuxer could be initialized
-		if (_up_webm_demuxer->isOpen())
+		// Convert current frame on first access
+		virtual const Image& current()
 		{
-			// Initialize further members
-			_up_webm_frame = std::unique_ptr<WebMFrame>(new WebMFrame);
-			_up_vpx_decoder = std::unique_ptr<VPXDecoder>(new VPXDecoder(*_up_webm_demuxer.get(), thread_count));
+			if (!_converted)
+			{
+				_converted = true;
+				_image.data.clear();
+				const Status status = _walker.convert(_image);
+				if (status != Status::OK)
+				{
+					_status = status;
+				}
+			}
+			return _image;
 		}
-		else
+
+		// Status of the range
+		virtual Status status() const
 		{
-			_up_webm_demuxer = nullptr;
+			return _walker._up_webm_demuxer ? _status : Status::ERR_FILE_NOT_FOUND;
 		}
-	}
 
-	// Destructor
-	VideoWalkerImpl::~VideoWalkerImpl()
-	{
-		// Do nothing
-	}
+	private:
 
-	// Walk over video, return true when more video frames are available
-	Status VideoWalkerImpl::walk(
-		std::shared_ptr<std::vector<Image> > sp_images,
-		const unsigned int count_to_extract,
-		unsigned int * p_extracted_count)
+		// Members
+		VideoWalkerImpl& _walker;
+		FrameRangeOptions _options;
+		Image _image; // recycled between frames
+		Status _status = Status::OK;
+		bool _started = false;
+		bool _converted = false;
+		unsigned int _index = 0; // count of frames within time range
+		unsigned int _taken = 0; // count of selected frames
+	};
+
+	/////////////////////////////////////////////////
+	/// MultiTrackWalkerImpl
+	/////////////////////////////////////////////////
+
+	// Implementation of multi-track walker class
+	class MultiTrackWalkerImpl : public MultiTrackWalker
 	{
-		// Check whether demuxer object has been correctly initialized
-		if (_up_webm_demuxer)
+	public:
+
+		// Constructor
+		MultiTrackWalkerImpl(const std::string webm_filepath, const std::vector<int>& tracks, const int thread_count, const Threading threading)
 		{
-			// Go over frames
+			// Create WebMDemuxer while opening video file
+			_up_webm_demuxer = std::unique_ptr<WebMDemuxer>(new WebMDemuxer(new MkvReader(webm_filepath.c_str())));
+			if (!_up_webm_demuxer->isOpen())
+			{
+				_up_webm_demuxer = nullptr;
+				return;
+			}
+
+			// Select tracks, each with its own decoder and packet queue in the demuxer. Blocks of other tracks are not parsed
+			_up_webm_demuxer->parseTracks(false, false);
+			const int track_count = _up_webm_demuxer->getVideoTrackCount();
+			for (int i = 0; i < track_count; ++i)
+			{
+				if (tracks.empty() || std::find(tracks.begin(), tracks.end(), i) != tracks.end())
+				{
+					std::unique_ptr<Track> up_track(new Track);
+					up_track->number = _up_webm_demuxer->getVideoTrackNumber(i);
+					up_track->up_vpx_decoder = std::unique_ptr<VPXDecoder>(new VPXDecoder(
+						_up_webm_demuxer->getVideoTrackCodec(i),
+						_up_webm_demuxer->getVideoTrackWidth(i),
+						to_vpx_threads(thread_count),
+						to_vpx_threading(threading)));
+					_up_webm_demuxer->enableTrack(up_track->number);
+					_tracks.push_back(std::move(up_track));
+					_track_indices.push_back(i);
+				}
+			}
+
+			// Own pool with one worker per track, as waiting for its tasks on the shared pool could starve it
+			if (!_tracks.empty())
+			{
+				_up_pool = std::unique_ptr<ThreadPool>(new ThreadPool((unsigned int)_tracks.size()));
+			}
+		}
+		MultiTrackWalkerImpl(const MultiTrackWalker&) = delete;
+		MultiTrackWalkerImpl& operator=(MultiTrackWalker const&) = delete;
+
+		// Walk over tracks into sink
+		virtual Status walk(
+			const TrackFrameSink& sink,
+			const unsigned int count_to_extract = 0,
+			unsigned int * p_extracted_count = nullptr)
+		{
+			// Check whether demuxer object has been correctly initialized
+			if (!_up_webm_demuxer)
+			{
+				if (p_extracted_count)
+				{
+					*p_extracted_count = 0;
+				}
+				return Status::ERR_FILE_NOT_FOUND;
+			}
+
+			// Merge decoded frames of all tracks by time
 			unsigned int i = 0;
 			bool frames_left = true;
-			while (frames_left && (i < count_to_extract || count_to_extract == 0))
+			bool stopped = false;
+			Status status = Status::OK;
+			while (frames_left && !stopped && (i < count_to_extract || count_to_extract == 0))
 			{
-				// Read next frame
-				if (
-					_up_webm_demuxer->readFrame(_up_webm_frame.get(), NULL) // get video frame, only
-					&& _up_webm_frame->isValid() // check frame for validity
-					&& _up_vpx_decoder->isOpen() // check whether decoder is still open
-					&& _up_vpx_decoder->decode(*_up_webm_frame.get())) // decode frame
+				// The earliest frame is known once every track either has a frame or is exhausted
+				Track* p_earliest = nullptr;
+				int earliest_index = 0;
+				bool missing = false;
+				for (size_t t = 0; t < _tracks.size(); ++t)
 				{
-					// Get image of decoded video frame
-					simplewebm::Image output_image;
-					output_image.time = _up_webm_frame->time;
-					if (_up_vpx_decoder->getImage(_vpx_image) == VPXDecoder::NO_ERROR)
+					Track& track = *_tracks[t];
+					if (track.images.empty())
 					{
-						// Get dimensions of the planes
-						const int y_width = _vpx_image.getWidth(0);
-						const int y_height = _vpx_image.getHeight(0);
-						const int y_linesize = _vpx_image.linesize[0];
-						const int u_width = _vpx_image.getWidth(1);
-						const int u_height = _vpx_image.getHeight(1);
-						const int u_linesize = _vpx_image.linesize[1];
-						const int v_width = _vpx_image.getWidth(2);
-						const int v_height = _vpx_image.getHeight(2);
-						const int v_linesize = _vpx_image.linesize[2];
-
-						// Check, whether dimensions are even
-						if (y_width % 2 != 0 || y_height % 2 != 0)
-						{
-							// TODO: maybe make global state to prohibit further walking
-							return Status::ERR_ODD_DIMENSION;
-						}
-						
-						// Calculate sample of u and v
-						const int u_steps_w = y_width / u_width;
-						const int u_steps_h = y_height / u_height;
-						const int v_steps_w = y_width / v_width;
-						const int v_steps_h = y_height / v_height;
-
-						// Push back new image into output
-						output_image.width = y_width;
-						output_image.height = y_height;
-						output_image.data.reserve(y_width * y_height * 3); // RGB
-
-						// Iterate over y plane
-						for (int i = 0; i < y_height; ++i)
-						{
-							for (int j = 0; j < y_width; ++j)
-							{
-								// Calculate index for u and v
-								const int u_i = i / u_steps_h;
-								const int u_j = j / u_steps_w;
-								const int v_i = i / v_steps_h;
-								const int v_j = j / v_steps_w;
-
-								// Extract YUV color of pixel
-								const int y = *(_vpx_image.planes[0] + (i * y_linesize) + j);
-								const int u = *(_vpx_image.planes[1] + (u_i * u_linesize) + u_j);
-								const int v = *(_vpx_image.planes[2] + (v_i * v_linesize) + v_j);
-
-								// Convert YUV to RGB
-								const int c = y - 16;
-								const int d = u - 128;
-								const int e = v - 128;
-								const char r = clamp8((298 * c + 409 * e + 128) >> 8);
-								const char g = clamp8((298 * c - 100 * d - 208 * e + 128) >> 8);
-								const char b = clamp8((298 * c + 516 * d + 128) >> 8);
-
-								// Set pixel value with BGR format
-								output_image.data.push_back(b);
-								output_image.data.push_back(g);
-								output_image.data.push_back(r);
-							}
-						}
+						missing = missing || !track.flushed;
+					}
+					else if (!p_earliest || track.images.front().time < p_earliest->images.front().time)
+					{
+						p_earliest = &track;
+						earliest_index = _track_indices[t];
 					}
-
-					// Move (!) image into output structure
-					sp_images->emplace_back(std::move(output_image));
-
-					// Increase count of extracted frames
-					++i;
 				}
-				else
+				if (missing)
+				{
+					if ((status = decode_batch()) != Status::OK)
+					{
+						break;
+					}
+					continue;
+				}
+				if (!p_earliest)
 				{
 					frames_left = false;
+					continue;
 				}
+
+				// Hand frame to sink
+				++i;
+				stopped = !sink(earliest_index, p_earliest->images.front());
+				p_earliest->images.pop_front();
 			}
 
 			// Provide ouput
@@ -279,27 +724,1215 @@ namespace simplewebm
 			}
 
 			// Tell user about frames
-			if (frames_left)
+			if (status != Status::OK)
 			{
-				return Status::OK;
-			}
-			else
-			{
-				return Status::DONE;
+				return status;
 			}
+			return frames_left ? Status::OK : Status::DONE;
 		}
-		else
-		{
-			// Provide ouput
-			if (p_extracted_count)
-			{
-				*p_extracted_count = 0;
-			}
 
-			// Educated guess why demuxer could not be initialized
-			return Status::ERR_FILE_NOT_FOUND;
+		// Indices of the selected tracks
+		virtual const std::vector<int>& get_tracks() const
+		{
+			return _track_indices;
 		}
-	}
+
+	private:
+
+		// Decoding state of one track
+		struct Track
+		{
+			long number = 0; // track number in the file
+			std::unique_ptr<VPXDecoder> up_vpx_decoder = nullptr;
+			std::vector<std::unique_ptr<WebMFrame> > packets; // packets of the current batch, recycled
+			size_t packet_count = 0; // packets of the current batch
+			bool ended = false; // whether all packets have been read
+			bool flushed = false; // whether decoder has been flushed after the last packet
+			std::deque<Image> images; // converted frames not handed to the sink yet
+			Status status = Status::OK;
+		};
+
+		// Demux a batch of packets for every track in one pass, then decode the tracks in parallel
+		Status decode_batch()
+		{
+			// Tracks holding enough frames wait, so that memory stays bounded while one track runs ahead
+			const size_t batch_size = 4;
+			std::vector<Track*> busy_tracks;
+			for (const std::unique_ptr<Track>& up_track : _tracks)
+			{
+				Track& track = *up_track;
+				if (track.flushed || track.images.size() >= batch_size)
+				{
+					continue;
+				}
+				track.packet_count = 0;
+				while (!track.ended && track.packet_count < batch_size)
+				{
+					if (track.packets.size() <= track.packet_count)
+					{
+						track.packets.emplace_back(new WebMFrame);
+					}
+					WebMFrame& packet = *track.packets[track.packet_count];
+					if (_up_webm_demuxer->readTrackFrame(track.number, &packet) && packet.isValid())
+					{
+						++track.packet_count;
+					}
+					else
+					{
+						track.ended = true;
+					}
+				}
+				busy_tracks.push_back(&track);
+			}
+
+			// Decode on the own pool of the walker, one task per track
+			std::vector<std::future<void> > futures;
+			for (Track* p_track : busy_tracks)
+			{
+				auto sp_task = std::make_shared<std::packaged_task<void()> >([p_track]() { decode_track(*p_track); });
+				futures.push_back(sp_task->get_future());
+				_up_pool->submit([sp_task]() { (*sp_task)(); });
+			}
+			for (std::future<void>& future : futures)
+			{
+				future.wait();
+			}
+			for (const Track* p_track : busy_tracks)
+			{
+				if (p_track->status != Status::OK)
+				{
+					return p_track->status;
+				}
+
+				// Packets of finished tracks are not queued anymore
+				if (p_track->flushed)
+				{
+					_up_webm_demuxer->disableTrack(p_track->number);
+				}
+			}
+			return Status::OK;
+		}
+
+		// Decode the batch of one track and convert its frames
+		static void decode_track(Track& track)
+		{
+			for (size_t i = 0; i < track.packet_count; ++i)
+			{
+				if (!track.up_vpx_decoder->isOpen() || !track.up_vpx_decoder->decode(*track.packets[i]))
+				{
+					track.ended = true;
+					break;
+				}
+				collect_images(track);
+			}
+
+			// Frame threading may still hold delayed images after the last packet
+			if (track.ended)
+			{
+				if (track.up_vpx_decoder->isOpen())
+				{
+					track.up_vpx_decoder->flush();
+					collect_images(track);
+				}
+				track.flushed = true;
+			}
+		}
+
+		// Convert the images the decoder of a track emits
+		static void collect_images(Track& track)
+		{
+			VPXDecoder::Image vpx_image;
+			VPXDecoder::IMAGE_ERROR error = VPXDecoder::NO_FRAME;
+			while ((error = track.up_vpx_decoder->getImage(vpx_image)) != VPXDecoder::NO_FRAME)
+			{
+				Image image;
+				const Status status = convert_image(vpx_image, error == VPXDecoder::NO_ERROR, image);
+				if (status != Status::OK)
+				{
+					track.status = status;
+					return;
+				}
+				track.images.push_back(std::move(image));
+			}
+		}
+
+		// Members
+		std::unique_ptr<WebMDemuxer> _up_webm_demuxer = nullptr; // splits tracks in one pass
+		std::vector<std::unique_ptr<Track> > _tracks; // selected tracks
+		std::vector<int> _track_indices; // indices of selected tracks among supported video tracks
+		std::unique_ptr<ThreadPool> _up_pool = nullptr; // decodes batches of tracks, declared last to join its workers first
+	};
+
+	/////////////////////////////////////////////////
+	/// AudioWalkerImpl
+	/////////////////////////////////////////////////
+
+	// Implementation of audio walker class
+	class AudioWalkerImpl : public AudioWalker
+	{
+	public:
+
+		// Constructor
+		AudioWalkerImpl(const std::string webm_filepath)
+		{
+			// Create WebMDemuxer while opening file, only its audio track is read
+			_up_webm_demuxer = std::unique_ptr<WebMDemuxer>(new WebMDemuxer(new MkvReader(webm_filepath.c_str())));
+			if (!_up_webm_demuxer->isOpen())
+			{
+				_up_webm_demuxer = nullptr;
+				return;
+			}
+			_up_webm_demuxer->parseTracks(false, true);
+
+			// Keep track parameters
+			switch (_up_webm_demuxer->getAudioCodec())
+			{
+			case WebMDemuxer::AUDIO_VORBIS:
+				_codec = AudioCodec::VORBIS;
+				break;
+			case WebMDemuxer::AUDIO_OPUS:
+				_codec = AudioCodec::OPUS;
+				break;
+			default:
+				return;
+			}
+			size_t size = 0;
+			const unsigned char* p_codec_private = _up_webm_demuxer->getAudioExtradata(size);
+			if (p_codec_private)
+			{
+				_codec_private.assign(p_codec_private, p_codec_private + size);
+			}
+			_seek_pre_roll = _up_webm_demuxer->getSeekPreRoll();
+			_codec_delay = _up_webm_demuxer->getCodecDelay();
+			_sample_rate = _up_webm_demuxer->getSampleRate();
+			_channels = _up_webm_demuxer->getChannels();
+		}
+		AudioWalkerImpl(const AudioWalker&) = delete;
+		AudioWalkerImpl& operator=(AudioWalker const&) = delete;
+
+		// Walk over audio into sink
+		virtual Status walk(
+			const AudioPacketSink& sink,
+			const unsigned int count_to_extract = 0,
+			unsigned int * p_extracted_count = nullptr)
+		{
+			// Check whether demuxer object has been correctly initialized
+			if (!_up_webm_demuxer)
+			{
+				if (p_extracted_count)
+				{
+					*p_extracted_count = 0;
+				}
+				return Status::ERR_FILE_NOT_FOUND;
+			}
+
+			// Go over packets of the audio track, payloads stay in the buffer of the demuxer frame
+			unsigned int i = 0;
+			bool packets_left = _codec != AudioCodec::NONE;
+			bool stopped = false;
+			while (packets_left && !stopped && (i < count_to_extract || count_to_extract == 0))
+			{
+				if (_up_webm_demuxer->readFrame(NULL, &_webm_frame) && _webm_frame.isValid())
+				{
+					AudioPacket packet;
+					packet.data = _webm_frame.getData();
+					packet.size = (size_t)_webm_frame.bufferSize;
+					packet.time = _webm_frame.time;
+					++i;
+					stopped = !sink(packet);
+				}
+				else
+				{
+					packets_left = false;
+				}
+			}
+
+			// Provide ouput
+			if (p_extracted_count)
+			{
+				*p_extracted_count = i;
+			}
+			return packets_left ? Status::OK : Status::DONE;
+		}
+
+		// Continue walking before time
+		virtual Status seek(const double time)
+		{
+			if (!_up_webm_demuxer)
+			{
+				return Status::ERR_FILE_NOT_FOUND;
+			}
+			return _codec != AudioCodec::NONE && _up_webm_demuxer->seekAudio(time - _seek_pre_roll) ? Status::OK : Status::DONE;
+		}
+
+		// Getters of track parameters
+		virtual AudioCodec get_codec() const { return _codec; }
+		virtual const std::vector<unsigned char>& get_codec_private() const { return _codec_private; }
+		virtual double get_seek_pre_roll() const { return _seek_pre_roll; }
+		virtual double get_codec_delay() const { return _codec_delay; }
+		virtual double get_sample_rate() const { return _sample_rate; }
+		virtual int get_channels() const { return _channels; }
+
+	private:
+
+		// Members
+		std::unique_ptr<WebMDemuxer> _up_webm_demuxer = nullptr; // reads audio track
+		WebMFrame _webm_frame; // holds payload of current packet
+		AudioCodec _codec = AudioCodec::NONE;
+		std::vector<unsigned char> _codec_private;
+		double _seek_pre_roll = 0.0;
+		double _codec_delay = 0.0;
+		double _sample_rate = 0.0;
+		int _channels = 0;
+	};
+
+	/////////////////////////////////////////////////
+	/// Probe definition
+	/////////////////////////////////////////////////
+
+	// Parse EBML header and top level elements of the segment up to the first cluster
+	static Status parse_headers(MkvReader& reader, std::unique_ptr<mkvparser::Segment>& up_segment)
+	{
+		if (!reader.isOpen())
+		{
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+		long long pos = 0;
+		mkvparser::Segment* p_segment = nullptr;
+		if (mkvparser::EBMLHeader().Parse(&reader, pos) || mkvparser::Segment::CreateInstance(&reader, pos, p_segment))
+		{
+			return Status::ERR_INVALID_FILE;
+		}
+		up_segment.reset(p_segment);
+		if (up_segment->ParseHeaders() != 0)
+		{
+			return Status::ERR_INVALID_FILE;
+		}
+		return Status::OK;
+	}
+
+	// Gather metadata from parsed headers, provides the described video track
+	static void read_info(const mkvparser::Segment& segment, VideoInfo& info, const mkvparser::VideoTrack** pp_video_track)
+	{
+		info = VideoInfo();
+		*pp_video_track = nullptr;
+
+		// Segment information
+		const long long duration = segment.GetInfo()->GetDuration();
+		if (duration >= 0)
+		{
+			info.duration = duration / 1e9;
+		}
+
+		// Cues are either parsed already or referenced by the SeekHead
+		info.has_cues = segment.GetCues() != nullptr || find_seek_entry(segment, libwebm::kMkvCues) >= 0;
+
+		// Tracks
+		const mkvparser::Tracks* p_tracks = segment.GetTracks();
+		for (unsigned long i = 0; i < p_tracks->GetTracksCount(); ++i)
+		{
+			const mkvparser::Track* p_track = p_tracks->GetTrackByIndex(i);
+			const char* p_codec_id = p_track ? p_track->GetCodecId() : nullptr;
+			if (!p_codec_id)
+			{
+				continue;
+			}
+			const std::string codec_id(p_codec_id);
+			if (p_track->GetType() == mkvparser::Track::kVideo && (codec_id == "V_VP8" || codec_id == "V_VP9"))
+			{
+				// Take first supported video track, like the walker does
+				if (info.video_track_count++ > 0)
+				{
+					continue;
+				}
+				const mkvparser::VideoTrack* p_video = static_cast<const mkvparser::VideoTrack*>(p_track);
+				*pp_video_track = p_video;
+				info.codec = codec_id == "V_VP8" ? VideoCodec::VP8 : VideoCodec::VP9;
+				info.width = (int)p_video->GetWidth();
+				info.height = (int)p_video->GetHeight();
+				if (p_video->GetFrameRate() > 0.0)
+				{
+					info.frame_rate = p_video->GetFrameRate();
+				}
+				else if (p_video->GetDefaultDuration() > 0)
+				{
+					info.frame_rate = 1e9 / p_video->GetDefaultDuration();
+				}
+				if (const mkvparser::Colour* p_colour = p_video->GetColour())
+				{
+					const long long absent = mkvparser::Colour::kValueNotPresent;
+					info.colour_matrix = p_colour->matrix_coefficients != absent ? p_colour->matrix_coefficients : -1;
+					info.colour_range = p_colour->range != absent ? p_colour->range : -1;
+					info.colour_transfer = p_colour->transfer_characteristics != absent ? p_colour->transfer_characteristics : -1;
+					info.colour_primaries = p_colour->primaries != absent ? p_colour->primaries : -1;
+					info.colour_bits_per_channel = p_colour->bits_per_channel != absent ? p_colour->bits_per_channel : -1;
+				}
+			}
+			else if (p_track->GetType() == mkvparser::Track::kAudio && info.audio_codec == AudioCodec::NONE)
+			{
+				if (codec_id == "A_VORBIS")
+				{
+					info.audio_codec = AudioCodec::VORBIS;
+				}
+				else if (codec_id == "A_OPUS")
+				{
+					info.audio_codec = AudioCodec::OPUS;
+				}
+			}
+		}
+	}
+
+	// Read metadata from headers
+	Status probe(const std::string webm_filepath, VideoInfo& info)
+	{
+		info = VideoInfo();
+		MkvReader reader(webm_filepath.c_str());
+		std::unique_ptr<mkvparser::Segment> up_segment;
+		const Status status = parse_headers(reader, up_segment);
+		if (status == Status::OK)
+		{
+			const mkvparser::VideoTrack* p_video_track = nullptr;
+			read_info(*up_segment, info, &p_video_track);
+		}
+		return status;
+	}
+
+	// Read inventory record of one file from headers and Cues
+	static void probe_record(ProbeRecord& record)
+	{
+		MkvReader reader(record.path.c_str());
+		std::unique_ptr<mkvparser::Segment> up_segment;
+		record.status = parse_headers(reader, up_segment);
+		reader.Length(&record.file_size, nullptr);
+		if (record.status != Status::OK)
+		{
+			return;
+		}
+		const mkvparser::VideoTrack* p_video_track = nullptr;
+		read_info(*up_segment, record.info, &p_video_track);
+
+		// Cue points of the video track, usually one per keyframe or per cluster
+		const long long cues_offset = find_seek_entry(*up_segment, libwebm::kMkvCues);
+		long long pos = 0;
+		long len = 0;
+		if (p_video_track && (up_segment->GetCues() || (cues_offset >= 0 && up_segment->ParseCues(cues_offset, pos, len) == 0)))
+		{
+			const mkvparser::Cues* p_cues = up_segment->GetCues();
+			while (p_cues && p_cues->LoadCuePoint())
+			{
+				// Load all cue points
+			}
+			for (const mkvparser::CuePoint* p_cue = p_cues ? p_cues->GetFirst() : nullptr; p_cue; p_cue = p_cues->GetNext(p_cue))
+			{
+				record.cue_count += p_cue->Find(p_video_track) ? 1 : 0;
+			}
+		}
+
+		// Files without Duration element, e.g. live recordings, are measured at their last cluster, as are the frame
+		// intervals of files without default duration, e.g. variable frame rate
+		double frame_rate = record.info.frame_rate;
+		double end_time = 0.0;
+		double frame_interval = 0.0;
+		if ((record.info.duration < 0.0 || frame_rate <= 0.0) && p_video_track
+			&& WebMDemuxer::estimateEnd(&reader, up_segment.get(), p_video_track->GetNumber(), end_time, frame_interval))
+		{
+			if (frame_rate <= 0.0 && frame_interval > 0.0)
+			{
+				frame_rate = 1.0 / frame_interval;
+				record.frame_count_estimated = true;
+			}
+			if (record.info.duration < 0.0)
+			{
+				record.duration_estimated = true;
+				record.info.duration = end_time + (frame_rate > 0.0 ? 1.0 / frame_rate : 0.0);
+			}
+		}
+
+		// Estimates from duration
+		if (record.info.duration > 0.0)
+		{
+			if (frame_rate > 0.0)
+			{
+				record.frame_count = (long long)(record.info.duration * frame_rate + 0.5);
+			}
+			if (record.cue_count > 0)
+			{
+				record.keyframe_interval = record.info.duration / record.cue_count;
+			}
+		}
+	}
+
+	// Read inventory records of many files in parallel
+	std::vector<ProbeRecord> probe_all(const std::vector<std::string>& webm_filepaths, const int thread_count)
+	{
+		std::vector<ProbeRecord> records(webm_filepaths.size());
+		std::unique_ptr<ThreadPool> up_pool(thread_count > 0 ? new ThreadPool((unsigned int)thread_count) : nullptr);
+		ThreadPool& pool = up_pool ? *up_pool : get_thread_pool();
+
+		// Queue one task per file and wait for all of them
+		std::vector<std::future<void> > futures;
+		futures.reserve(records.size());
+		for (size_t i = 0; i < records.size(); ++i)
+		{
+			records[i].path = webm_filepaths[i];
+			ProbeRecord* p_record = &records[i];
+			auto sp_task = std::make_shared<std::packaged_task<void()> >([p_record]() { probe_record(*p_record); });
+			futures.push_back(sp_task->get_future());
+			pool.submit([sp_task]() { (*sp_task)(); });
+		}
+		for (std::future<void>& future : futures)
+		{
+			future.wait();
+		}
+		return records;
+	}
+
+	/////////////////////////////////////////////////
+	/// VideoWalker factory definition
+	/////////////////////////////////////////////////
+
+	// Factory of video walkers
+	std::unique_ptr<VideoWalker> create_video_walker(const std::string webm_filepath, const int thread_count, const Threading threading, const FollowOptions& follow)
+	{
+		return std::unique_ptr<VideoWalker>(new VideoWalkerImpl(webm_filepath, thread_count, threading, follow));
+	}
+
+	// Factory of video walkers over memory
+	std::unique_ptr<VideoWalker> create_memory_video_walker(const unsigned char* p_data, const size_t size, const int thread_count, const Threading threading)
+	{
+		return std::unique_ptr<VideoWalker>(new VideoWalkerImpl(new MemoryReader(p_data, size), thread_count, threading));
+	}
+
+	/////////////////////////////////////////////////
+	/// MultiTrackWalker factory definition
+	/////////////////////////////////////////////////
+
+	// Factory of multi-track walkers
+	std::unique_ptr<MultiTrackWalker> create_multi_track_walker(const std::string webm_filepath, const std::vector<int>& tracks, const int thread_count, const Threading threading)
+	{
+		return std::unique_ptr<MultiTrackWalker>(new MultiTrackWalkerImpl(webm_filepath, tracks, thread_count, threading));
+	}
+
+	// Constructor of base class
+	MultiTrackWalker::MultiTrackWalker()
+	{
+		// Do nothing
+	}
+
+	// Destructor of base class
+	MultiTrackWalker::~MultiTrackWalker()
+	{
+		// Do nothing
+	}
+
+	/////////////////////////////////////////////////
+	/// AudioWalker factory definition
+	/////////////////////////////////////////////////
+
+	// Factory of audio walkers
+	std::unique_ptr<AudioWalker> create_audio_walker(const std::string webm_filepath)
+	{
+		return std::unique_ptr<AudioWalker>(new AudioWalkerImpl(webm_filepath));
+	}
+
+	// Constructor of base class
+	AudioWalker::AudioWalker()
+	{
+		// Do nothing
+	}
+
+	// Destructor of base class
+	AudioWalker::~AudioWalker()
+	{
+		// Do nothing
+	}
+
+	/////////////////////////////////////////////////
+	/// VideoWalkerImpl Definition
+	/////////////////////////////////////////////////
+
+	// Constructor of base class
+	VideoWalker::VideoWalker()
+	{
+		// Do nothing
+	}
+
+	// Destructor of base class
+	VideoWalker::~VideoWalker()
+	{
+		// Do nothing
+	}
+
+	// Constructor
+	VideoWalkerImpl::VideoWalkerImpl(const std::string webm_filepath, const int thread_count, const Threading threading, const FollowOptions& follow) :
+		VideoWalker(), _follow(follow)
+	{
+		// Create WebMDemuxer while opening video file, a followed file is waited for when running out of data
+		_p_reader = new MkvReader(webm_filepath.c_str(), _follow.enabled);
+		std::function<bool()> wait;
+		if (_follow.enabled)
+		{
+			wait = [this]() { return wait_for_data(); };
+		}
+		_up_webm_demuxer = std::unique_ptr<WebMDemuxer>(new WebMDemuxer(_p_reader, 0, 0, wait));
+		open_decoder(thread_count, threading);
+	}
+
+	// Constructor with reader, e.g. of memory
+	VideoWalkerImpl::VideoWalkerImpl(mkvparser::IMkvReader* p_reader, const int thread_count, const Threading threading) : VideoWalker()
+	{
+		_up_webm_demuxer = std::unique_ptr<WebMDemuxer>(new WebMDemuxer(p_reader));
+		open_decoder(thread_count, threading);
+	}
+
+	// Create decoder once demuxer has been created
+	void VideoWalkerImpl::open_decoder(const int thread_count, const Threading threading)
+	{
+		// Continue when demuxer could be initialized
+		if (_up_webm_demuxer->isOpen())
+		{
+			// Audio blocks are skipped while parsing
+			_up_webm_demuxer->parseTracks(true, false);
+
+			// Initialize further members
+			_up_webm_frame = std::unique_ptr<WebMFrame>(new WebMFrame);
+			_up_held_frame = std::unique_ptr<WebMFrame>(new WebMFrame);
+			_up_vpx_decoder = std::unique_ptr<VPXDecoder>(new VPXDecoder(*_up_webm_demuxer.get(), to_vpx_threads(thread_count), to_vpx_threading(threading)));
+		}
+		else
+		{
+			_up_webm_demuxer = nullptr;
+		}
+	}
+
+	// Destructor
+	VideoWalkerImpl::~VideoWalkerImpl()
+	{
+		// Do nothing
+	}
+
+	// Walk over video, return true when more video frames are available
+	Status VideoWalkerImpl::walk(
+		std::shared_ptr<std::vector<Image> > sp_images,
+		const unsigned int count_to_extract,
+		unsigned int * p_extracted_count)
+	{
+		// Continue after the frame of the last random access
+		sync_position();
+
+		// Check whether demuxer object has been correctly initialized
+		if (_up_webm_demuxer)
+		{
+			// Go over frames
+			unsigned int i = 0;
+			bool frames_left = true;
+			while (frames_left && (i < count_to_extract || count_to_extract == 0))
+			{
+				// Decode next frame
+				if (decode_next_unique())
+				{
+					// Convert image of decoded video frame
+					simplewebm::Image output_image;
+					const Status status = convert(output_image);
+					if (status != Status::OK)
+					{
+						// TODO: maybe make global state to prohibit further walking
+						return status;
+					}
+
+					// Move (!) image into output structure
+					sp_images->emplace_back(std::move(output_image));
+
+					// Increase count of extracted frames
+					++i;
+				}
+				else
+				{
+					frames_left = false;
+				}
+			}
+
+			// Provide ouput
+			if (p_extracted_count)
+			{
+				*p_extracted_count = i;
+			}
+
+			// Tell user about frames
+			if (frames_left)
+			{
+				return Status::OK;
+			}
+			else
+			{
+				return Status::DONE;
+			}
+		}
+		else
+		{
+			// Provide ouput
+			if (p_extracted_count)
+			{
+				*p_extracted_count = 0;
+			}
+
+			// Educated guess why demuxer could not be initialized
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+	}
+
+	// Walk over video into sink
+	Status VideoWalkerImpl::walk(
+		const FrameSink& sink,
+		const unsigned int count_to_extract,
+		unsigned int * p_extracted_count)
+	{
+		return walk_sink(sink, count_to_extract, p_extracted_count, []() { return Status::OK; });
+	}
+
+	// Walk over time range into sink
+	Status VideoWalkerImpl::walk_range(
+		const double from,
+		const double to,
+		const FrameSink& sink,
+		unsigned int * p_extracted_count)
+	{
+		// Continue after the frame of the last random access
+		sync_position();
+
+		// Provide ouput
+		if (p_extracted_count)
+		{
+			*p_extracted_count = 0;
+		}
+
+		// Check whether demuxer object has been correctly initialized
+		if (!_up_webm_demuxer)
+		{
+			// Educated guess why demuxer could not be initialized
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+
+		// Nothing lies in an empty range
+		if (to < from)
+		{
+			return Status::OK;
+		}
+
+		// Go back to the keyframe at or before start of range when it has been passed or the video is exhausted,
+		// otherwise skip ahead unless no keyframe lies in between
+		const bool passed = _has_image ? (_vpx_image.time >= from) : _draining;
+		const bool positioned = passed ? seek(from) : skip_to(from);
+		if (!positioned)
+		{
+			return Status::DONE;
+		}
+
+		// Go over frames until the next one lies beyond the range
+		unsigned int i = 0;
+		double next = 0.0;
+		while (!next_time(next) || next <= to)
+		{
+			// Decode next frame
+			if (!decode_next_unique())
+			{
+				return Status::DONE;
+			}
+
+			// Frames before the range are only decoded as reference of the following ones
+			if (_vpx_image.time < from)
+			{
+				continue;
+			}
+			if (_vpx_image.time > to)
+			{
+				break;
+			}
+
+			// Convert into recycled image, keeping the capacity of its pixel data
+			_sink_image.data.clear();
+			const Status status = convert(_sink_image);
+			if (status != Status::OK)
+			{
+				return status;
+			}
+
+			// Increase count of extracted frames
+			++i;
+			if (p_extracted_count)
+			{
+				*p_extracted_count = i;
+			}
+
+			// Hand image to sink
+			if (!sink(_sink_image))
+			{
+				break;
+			}
+		}
+		return Status::OK;
+	}
+
+	// Walk over selected frames into sink
+	Status VideoWalkerImpl::walk_sampled(
+		const SamplingOptions& options,
+		const FrameSink& sink,
+		unsigned int * p_extracted_count)
+	{
+		// Continue after the frame of the last random access
+		sync_position();
+
+		// Provide ouput
+		if (p_extracted_count)
+		{
+			*p_extracted_count = 0;
+		}
+
+		// Check whether demuxer object has been correctly initialized
+		if (!_up_webm_demuxer)
+		{
+			// Educated guess why demuxer could not be initialized
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+
+		// Targets are the given times or the ticks of the output frame rate, which start at the first frame
+		const bool by_time = !options.times.empty() || options.fps > 0.0;
+		const unsigned int every = std::max(options.every, 1u);
+		auto target = [&options](const size_t index, const double first_time, double& time)
+		{
+			if (!options.times.empty())
+			{
+				if (index >= options.times.size())
+				{
+					return false;
+				}
+				time = options.times[index];
+				return true;
+			}
+			time = first_time + index / options.fps;
+			return true;
+		};
+
+		// Frames are selected as well when they are read, so that unselected frames which nothing references are
+		// not decoded at all. A frame is selected on reading when a target lies between the previous frame and the
+		// middle to the following one, which includes all targets it is nearest to. Frames passed to the decoder
+		// before the walk would come out unseen, then every frame is decoded.
+		double pending_time = 0.0;
+		const bool select_read = !_up_vpx_decoder->getPendingTime(pending_time);
+		std::deque<double> selected_times; // times of frames selected by stride when read
+		unsigned long long read_index = 0;
+		size_t read_target_index = 0;
+		double read_first_time = 0.0;
+		double previous_time = -std::numeric_limits<double>::infinity();
+		const std::function<bool(double, bool)> unselected = [&](const double time, const bool shown)
+		{
+			if (!shown)
+			{
+				return true;
+			}
+			if (!by_time)
+			{
+				if ((read_index++ % every) != 0)
+				{
+					return true;
+				}
+				selected_times.push_back(time);
+				return false;
+			}
+			if (read_index++ == 0)
+			{
+				read_first_time = time;
+			}
+			double next = 0.0;
+			if (!_up_webm_demuxer->peekVideoTime(next))
+			{
+				next = std::numeric_limits<double>::infinity();
+			}
+			double target_time = 0.0;
+			while (target(read_target_index, read_first_time, target_time) && target_time <= previous_time)
+			{
+				++read_target_index;
+			}
+			previous_time = time;
+			return !(target(read_target_index, read_first_time, target_time) && target_time <= (time + next) / 2.0 + 1e-9);
+		};
+
+		// Go over frames
+		unsigned int i = 0;
+		unsigned long long index = 0;
+		size_t target_index = 0;
+		double first_time = 0.0;
+		double target_time = 0.0;
+		Status status = Status::OK;
+		_p_unselected = select_read ? &unselected : nullptr;
+		while (!by_time || target(target_index, first_time, target_time))
+		{
+			// Decode next frame
+			if (!decode_next())
+			{
+				status = Status::DONE;
+				break;
+			}
+			const double time = _vpx_image.time;
+			if (index++ == 0)
+			{
+				first_time = time;
+			}
+
+			// Count how many targets the frame is nearest to, the following frame decides whether it is nearer.
+			// The last frame takes the remaining times but only the ticks up to half a tick after it
+			unsigned int selected = 0;
+			if (by_time)
+			{
+				double next = 0.0;
+				if (!next_time(next))
+				{
+					next = options.times.empty() ? time + 1.0 / options.fps : std::numeric_limits<double>::infinity();
+				}
+				while (target(target_index, first_time, target_time) && std::abs(time - target_time) <= std::abs(next - target_time))
+				{
+					++selected;
+					++target_index;
+				}
+			}
+			else if (select_read)
+			{
+				while (!selected_times.empty() && selected_times.front() < time)
+				{
+					selected_times.pop_front();
+				}
+				if (!selected_times.empty() && selected_times.front() == time)
+				{
+					selected_times.pop_front();
+					selected = 1;
+				}
+			}
+			else
+			{
+				selected = ((index - 1) % every) == 0 ? 1 : 0;
+			}
+			if (selected == 0)
+			{
+				continue;
+			}
+
+			// Convert into recycled image once, keeping the capacity of its pixel data
+			_sink_image.data.clear();
+			status = convert(_sink_image);
+			if (status != Status::OK)
+			{
+				break;
+			}
+
+			// Hand image to sink once per target
+			bool stopped = false;
+			for (unsigned int s = 0; s < selected && !stopped; ++s)
+			{
+				++i;
+				if (p_extracted_count)
+				{
+					*p_extracted_count = i;
+				}
+				stopped = !sink(_sink_image);
+			}
+			if (stopped)
+			{
+				break;
+			}
+		}
+		_p_unselected = nullptr;
+		return status;
+	}
+
+	// Walk over video at a constant frame rate into sink
+	Status VideoWalkerImpl::walk_cfr(
+		const double fps,
+		const TickSink& sink,
+		unsigned int * p_tick_count)
+	{
+		// Continue after the frame of the last random access
+		sync_position();
+
+		// Provide ouput
+		if (p_tick_count)
+		{
+			*p_tick_count = 0;
+		}
+
+		// Check whether demuxer object has been correctly initialized
+		if (!_up_webm_demuxer)
+		{
+			// Educated guess why demuxer could not be initialized
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+		if (fps <= 0.0)
+		{
+			return Status::OK;
+		}
+
+		// Each tick shows the last frame at or before its time, so frames are shown from the first tick at or after their
+		// time on, relative to the first frame. Times within half a timecode of a tick count as on it, as they are rounded.
+		double first_time = 0.0;
+		const double tolerance = std::max(_up_webm_demuxer->getTimeScale() / 2.0, 1e-9) * fps;
+		auto tick_of = [&first_time, fps, tolerance](const double time)
+		{
+			return (long long)std::ceil((time - first_time) * fps - tolerance);
+		};
+
+		// Frames shown by no tick are not decoded either when nothing references them, see walk_sampled.
+		// Here a frame is shown by no tick when the following frame starts at the same tick.
+		double pending_time = 0.0;
+		const bool select_read = !_up_vpx_decoder->getPendingTime(pending_time);
+		bool read_first = true;
+		const std::function<bool(double, bool)> unselected = [&](const double time, const bool shown)
+		{
+			if (!shown)
+			{
+				return true;
+			}
+			if (read_first)
+			{
+				read_first = false;
+				first_time = time;
+			}
+			double next = 0.0;
+			return _up_webm_demuxer->peekVideoTime(next) && tick_of(next) <= tick_of(time);
+		};
+
+		// Go over frames
+		unsigned int i = 0;
+		long long tick = 0;
+		bool first = true;
+		std::shared_ptr<Image> sp_image;
+		bool image_is_reference = false; // whether image shows the frame that duplicates are compared with
+		Status status = Status::OK;
+		_p_unselected = select_read ? &unselected : nullptr;
+		while (true)
+		{
+			// Decode next frame
+			if (!decode_next())
+			{
+				status = Status::DONE;
+				break;
+			}
+			if (first)
+			{
+				first = false;
+				first_time = _vpx_image.time;
+			}
+
+			// Frame is shown until the tick of the following frame, the last frame until the end of the video
+			double next = 0.0;
+			long long end_tick = 0;
+			if (next_time(next))
+			{
+				end_tick = tick_of(next);
+			}
+			else
+			{
+				const double length = _up_webm_demuxer->getLength();
+				end_tick = length > _vpx_image.time ? tick_of(length) : tick_of(_vpx_image.time) + 1;
+			}
+			tick = std::max(tick, tick_of(_vpx_image.time));
+			if (tick >= end_tick)
+			{
+				image_is_reference &= _duplicate;
+				continue;
+			}
+
+			// Convert into image of its own, shared by the ticks showing it. Duplicates share the previous image.
+			if (!_duplicate || !image_is_reference)
+			{
+				sp_image = std::make_shared<Image>();
+				status = convert(*sp_image);
+				if (status != Status::OK)
+				{
+					break;
+				}
+				image_is_reference = true;
+			}
+
+			// Hand image to sink once per tick
+			bool stopped = false;
+			for (; tick < end_tick && !stopped; ++tick)
+			{
+				++i;
+				if (p_tick_count)
+				{
+					*p_tick_count = i;
+				}
+				stopped = !sink(first_time + tick / fps, sp_image);
+			}
+			if (stopped)
+			{
+				status = Status::OK;
+				break;
+			}
+		}
+		_p_unselected = nullptr;
+		return status;
+	}
+
+	// Walk over video at a constant frame rate into vector
+	Status VideoWalkerImpl::walk_cfr(
+		const double fps,
+		std::shared_ptr<std::vector<std::shared_ptr<const Image> > > sp_ticks,
+		unsigned int * p_tick_count)
+	{
+		return walk_cfr(fps, [&sp_ticks](double, const std::shared_ptr<const Image>& sp_image)
+		{
+			sp_ticks->push_back(sp_image);
+			return true;
+		}, p_tick_count);
+	}
+
+	// Walk over changed regions into canvas
+	Status VideoWalkerImpl::walk_changes(
+		Image& canvas,
+		const ChangeSink& sink,
+		const int tile_size,
+		unsigned int * p_extracted_count)
+	{
+		// Continue after the frame of the last random access
+		sync_position();
+
+		// Provide ouput
+		if (p_extracted_count)
+		{
+			*p_extracted_count = 0;
+		}
+
+		// Check whether demuxer object has been correctly initialized
+		if (!_up_webm_demuxer)
+		{
+			// Educated guess why demuxer could not be initialized
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+
+		// Tiles cover whole chroma samples
+		const int tile = std::max(2, (tile_size + 1) & ~1);
+
+		// Go over frames, keeping the planes of the previous frame as the decoder reuses its buffers
+		unsigned int i = 0;
+		std::vector<unsigned char> previous_data;
+		YUVPlanes previous = YUVPlanes();
+		bool has_previous = false;
+		std::vector<Rect> changes;
+		while (decode_next_unique())
+		{
+			canvas.time = _vpx_image.time;
+			canvas.duplicate = _duplicate;
+			changes.clear();
+
+			// Frames in unsupported format change nothing
+			if (_vpx_image_valid)
+			{
+				YUVPlanes current;
+				for (int plane = 0; plane < 3; ++plane)
+				{
+					current.p_data[plane] = _vpx_image.planes[plane];
+					current.linesize[plane] = _vpx_image.linesize[plane];
+				}
+				current.width = _vpx_image.getWidth(0);
+				current.height = _vpx_image.getHeight(0);
+				current.chroma_shift_w = _vpx_image.chromaShiftW;
+				current.chroma_shift_h = _vpx_image.chromaShiftH;
+				if (current.width % 2 != 0 || current.height % 2 != 0)
+				{
+					return Status::ERR_ODD_DIMENSION;
+				}
+
+				// Compare with previous frame in tiles, unless canvas has to be filled anew
+				const bool comparable =
+					has_previous
+					&& current.width == previous.width
+					&& current.height == previous.height
+					&& current.chroma_shift_w == previous.chroma_shift_w
+					&& current.chroma_shift_h == previous.chroma_shift_h
+					&& canvas.width == current.width
+					&& canvas.height == current.height
+					&& canvas.data.size() == (size_t)current.width * current.height * 3;
+				if (comparable)
+				{
+					changed_tiles(current, previous, tile, changes);
+				}
+				else
+				{
+					canvas.width = current.width;
+					canvas.height = current.height;
+					canvas.data.assign((size_t)current.width * current.height * 3, 0);
+					Rect rect;
+					rect.width = current.width;
+					rect.height = current.height;
+					changes.push_back(rect);
+				}
+
+				// Convert changed regions only
+				for (const Rect& rect : changes)
+				{
+					convert_rect(_vpx_image, rect, canvas);
+				}
+
+				// Keep planes as previous frame
+				previous = pack_planes(_vpx_image, previous_data);
+				has_previous = true;
+			}
+
+			// Hand canvas to sink
+			++i;
+			if (p_extracted_count)
+			{
+				*p_extracted_count = i;
+			}
+			if (!sink(canvas, changes))
+			{
+				return Status::OK;
+			}
+		}
+		return Status::DONE;
+	}
+
+	// Walk over video asynchronously
+	std::future<Status> VideoWalkerImpl::walk_async(
+		const FrameSink& sink,
+		const AsyncOptions& options)
+	{
+		// Interrupt between frames once cancelled or late
+		const CancellationToken token = options.token;
+		const std::chrono::steady_clock::time_point deadline = options.deadline;
+		const std::function<Status()> interrupt = [token, deadline]()
+		{
+			if (token.is_cancelled())
+			{
+				return Status::CANCELLED;
+			}
+			if (deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline)
+			{
+				return Status::DEADLINE_EXCEEDED;
+			}
+			return Status::OK;
+		};
+
+		// Run walk on its own thread, as it blocks for its whole length and would occupy a worker of the internal pool
+		const unsigned int count_to_extract = options.count_to_extract;
+		const std::function<void(Status, unsigned int)> on_complete = options.on_complete;
+		return std::async(std::launch::async, [this, sink, count_to_extract, on_complete, interrupt]()
+		{
+			unsigned int extracted_count = 0;
+			const Status status = walk_sink(sink, count_to_extract, &extracted_count, interrupt);
+			if (on_complete)
+			{
+				on_complete(status, extracted_count);
+			}
+			return status;
+		});
+	}
+
+	// Lazy range over frames
+	FrameRange VideoWalkerImpl::frames(const FrameRangeOptions& options)
+	{
+		return FrameRange(std::make_shared<WalkerFrameSource>(*this, options));
+	}
 
 	// Dry walk
 	Status VideoWalkerImpl::dry_walk(
@@ -307,6 +1940,9 @@ namespace simplewebm
 		const unsigned int count_to_extract,
 		unsigned int * p_extracted_count)
 	{
+		// Continue after the frame of the last random access
+		sync_position();
+
 		// Check whether demuxer object has been correctly initialized
 		if (_up_webm_demuxer)
 		{
@@ -315,15 +1951,11 @@ namespace simplewebm
 			bool frames_left = true;
 			while (frames_left && (i < count_to_extract || count_to_extract == 0))
 			{
-				// Read next frame
-				if (
-					_up_webm_demuxer->readFrame(_up_webm_frame.get(), NULL) // get video frame, only
-					&& _up_webm_frame->isValid() // check frame for validity
-					&& _up_vpx_decoder->isOpen() // check whether decoder is still open
-					&& _up_vpx_decoder->decode(*_up_webm_frame.get())) // decode frame
+				// Decode next frame
+				if (decode_next())
 				{
 					// Emplace time
-					sp_times->emplace_back(std::move(_up_webm_frame->time));
+					sp_times->emplace_back(_vpx_image.time);
 
 					// Increase count of extracted frames
 					++i;
@@ -362,4 +1994,475 @@ namespace simplewebm
 			return Status::ERR_FILE_NOT_FOUND;
 		}
 	}
+
+	// Get frame at time
+	Status VideoWalkerImpl::get_frame_at(const double time, Image& image)
+	{
+		// Check whether demuxer object has been correctly initialized
+		if (!_up_webm_demuxer)
+		{
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+		return fetch_at(time, image);
+	}
+
+	// Get frames at times
+	Status VideoWalkerImpl::get_frames_at(
+		const std::vector<double>& times,
+		std::shared_ptr<std::vector<Image> > sp_images)
+	{
+		// Check whether demuxer object has been correctly initialized
+		if (!_up_webm_demuxer)
+		{
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+
+		// Visit times in sorted order
+		std::vector<size_t> order(times.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&times](size_t a, size_t b) { return times[a] < times[b]; });
+
+		// Go over times
+		std::vector<Image> images(times.size());
+		const Image* p_previous = nullptr;
+		double previous_end_time = 0.0;
+		for (const size_t i : order)
+		{
+			// Times shown by the same frame share its conversion
+			if (p_previous && times[i] < previous_end_time)
+			{
+				images[i] = *p_previous;
+				continue;
+			}
+
+			const Status status = fetch_at(times[i], images[i]);
+			if (status != Status::OK)
+			{
+				return status;
+			}
+			p_previous = &images[i];
+			previous_end_time = _last_end_time;
+		}
+
+		// Move (!) images into output structure
+		for (Image& image : images)
+		{
+			sp_images->emplace_back(std::move(image));
+		}
+		return Status::OK;
+	}
+
+	// Set frame cache budget
+	void VideoWalkerImpl::set_frame_cache(const size_t max_bytes)
+	{
+		_frame_cache.set_capacity(max_bytes);
+	}
+
+	// Get frame cache statistics
+	CacheStats VideoWalkerImpl::get_frame_cache_stats() const
+	{
+		return _frame_cache.get_stats();
+	}
+
+	// Set duplicate detection, the next frame is compared with the frames after it
+	void VideoWalkerImpl::set_duplicate_detection(const DuplicateOptions& options)
+	{
+		_duplicates = options;
+		_has_reference = false;
+		_duplicate = false;
+	}
+
+	// Get frame at time through the frame cache
+	Status VideoWalkerImpl::fetch_at(const double time, Image& image)
+	{
+		// Serve from cache when possible
+		if (const Image* p_cached = _frame_cache.find(time, _last_end_time))
+		{
+			image = *p_cached;
+			_position_pending = true;
+			_pending_time = time;
+			return Status::OK;
+		}
+
+		// Decode and convert frame
+		_position_pending = false;
+		if (!decode_at(time, _last_end_time))
+		{
+			return Status::DONE;
+		}
+		image.data.clear();
+		const Status status = convert(image);
+
+		// The last frame of a followed file is shown only until the file grows, so it is not cached
+		const bool open_ended = _last_end_time == std::numeric_limits<double>::max();
+		if (status == Status::OK && !(open_ended && _follow.enabled))
+		{
+			_frame_cache.insert(image, _last_end_time);
+		}
+		return status;
+	}
+
+	// Decode up to the frame that random access last served from the cache
+	void VideoWalkerImpl::sync_position()
+	{
+		if (_position_pending && _up_webm_demuxer)
+		{
+			_position_pending = false;
+			double end_time = 0.0;
+			decode_at(_pending_time, end_time);
+		}
+	}
+
+	// Decode the image shown at time
+	bool VideoWalkerImpl::decode_at(const double time, double& end_time)
+	{
+		// Decoding forward is cheaper than seeking as long as no keyframe lies between current image and time
+		double key_time = 0.0;
+		const bool forward =
+			_has_image
+			&& _vpx_image.time <= time
+			&& _up_webm_demuxer->getVideoKeyFrameTime(time, key_time)
+			&& key_time <= _vpx_image.time;
+		if (!forward)
+		{
+			if (!seek(time) || !decode_next())
+			{
+				return false;
+			}
+		}
+
+		// Decode until the following frame would be shown after time
+		while (true)
+		{
+			if (!next_time(end_time))
+			{
+				end_time = std::numeric_limits<double>::max(); // last frame is shown forever
+				return true;
+			}
+			if (end_time > time)
+			{
+				return true;
+			}
+			if (!decode_next())
+			{
+				return false;
+			}
+		}
+	}
+
+	// Time of the frame following the current decoded image
+	bool VideoWalkerImpl::next_time(double& time)
+	{
+		// Frames already passed to the decoder come first, demuxer provides the rest
+		if (_up_vpx_decoder->getPendingTime(time))
+		{
+			return true;
+		}
+		if (_held)
+		{
+			time = _up_held_frame->time;
+			return true;
+		}
+		return !_draining && _up_webm_demuxer->peekVideoTime(time);
+	}
+
+	// Seek to keyframe at or before time
+	bool VideoWalkerImpl::seek(const double time)
+	{
+		if (!_up_vpx_decoder->isOpen() || !_up_webm_demuxer->seekVideo(time))
+		{
+			return false;
+		}
+		_up_vpx_decoder->reset();
+		_has_image = false;
+		_position_pending = false;
+		_has_reference = false;
+		_held = false;
+		_draining = false;
+		_flushed = false;
+		return true;
+	}
+
+	// Walk over video into sink while interrupt returns OK
+	Status VideoWalkerImpl::walk_sink(
+		const FrameSink& sink,
+		const unsigned int count_to_extract,
+		unsigned int * p_extracted_count,
+		const std::function<Status()>& interrupt)
+	{
+		// Continue after the frame of the last random access
+		sync_position();
+
+		// Check whether demuxer object has been correctly initialized
+		if (_up_webm_demuxer)
+		{
+			// Go over frames
+			unsigned int i = 0;
+			bool frames_left = true;
+			bool stopped = false;
+			Status interrupt_status = Status::OK;
+			_p_interrupt = &interrupt;
+			while (frames_left && !stopped && (i < count_to_extract || count_to_extract == 0))
+			{
+				// Stop before decoding and before converting when interrupted
+				if ((interrupt_status = interrupt()) != Status::OK)
+				{
+					break;
+				}
+
+				// Decode next frame
+				if (decode_next_unique())
+				{
+					if ((interrupt_status = interrupt()) != Status::OK)
+					{
+						break;
+					}
+
+					// Convert into recycled image, keeping the capacity of its pixel data
+					_sink_image.data.clear();
+					const Status status = convert(_sink_image);
+					if (status != Status::OK)
+					{
+						_p_interrupt = nullptr;
+						return status;
+					}
+
+					// Increase count of extracted frames
+					++i;
+
+					// Hand image to sink
+					stopped = !sink(_sink_image);
+				}
+				else
+				{
+					// Waiting for a followed file ends early when interrupted
+					if (_follow.enabled)
+					{
+						interrupt_status = interrupt();
+					}
+					frames_left = false;
+				}
+			}
+			_p_interrupt = nullptr;
+
+			// Provide ouput
+			if (p_extracted_count)
+			{
+				*p_extracted_count = i;
+			}
+
+			// Tell user about frames
+			if (interrupt_status != Status::OK)
+			{
+				return interrupt_status;
+			}
+			else if (frames_left)
+			{
+				return Status::OK;
+			}
+			else
+			{
+				return Status::DONE;
+			}
+		}
+		else
+		{
+			// Provide ouput
+			if (p_extracted_count)
+			{
+				*p_extracted_count = 0;
+			}
+
+			// Educated guess why demuxer could not be initialized
+			return Status::ERR_FILE_NOT_FOUND;
+		}
+	}
+
+	// Seek when time lies beyond the current group of pictures
+	bool VideoWalkerImpl::skip_to(const double time)
+	{
+		// Nothing to skip when time is not ahead of the current image or video is exhausted
+		if ((_has_image && time <= _vpx_image.time) || (!_has_image && _draining))
+		{
+			return true;
+		}
+
+		// Keep decoding forward when no keyframe lies between current position and time
+		double key_time = 0.0;
+		if (!_up_webm_demuxer->getVideoKeyFrameTime(time, key_time))
+		{
+			return true;
+		}
+		const double position = _has_image ? _vpx_image.time : std::numeric_limits<double>::lowest();
+		if (key_time <= position)
+		{
+			return true;
+		}
+		return seek(time);
+	}
+
+	// Decode until the decoder emits the next image, return false when video is exhausted
+	bool VideoWalkerImpl::decode_next()
+	{
+		while (true)
+		{
+			// Collect image that the decoder already holds
+			const VPXDecoder::IMAGE_ERROR error = _up_vpx_decoder->getImage(_vpx_image);
+			if (error != VPXDecoder::NO_FRAME)
+			{
+				_vpx_image_valid = (error == VPXDecoder::NO_ERROR);
+				_has_image = true;
+				_flushed = false;
+				detect_duplicate();
+				return true;
+			}
+
+			// Feed decoder with next frame as long as there are frames
+			if (!_draining)
+			{
+				if (
+					read_next() // get video frame, only
+					&& _up_vpx_decoder->isOpen() // check whether decoder is still open
+					&& (drop_next() || _up_vpx_decoder->decode(*_up_webm_frame.get()))) // decode frame unless dropped
+				{
+					continue;
+				}
+
+				// End of stream, frame threading may still hold delayed images
+				_draining = true;
+			}
+
+			// Flush decoder until it does not return any more images
+			if (_flushed || !_up_vpx_decoder->isOpen())
+			{
+				_has_image = false;
+				return false;
+			}
+			_up_vpx_decoder->flush();
+			_flushed = true;
+		}
+	}
+
+	// Read next video frame, the frame read ahead comes first
+	bool VideoWalkerImpl::read_next()
+	{
+		if (_held)
+		{
+			_held = false;
+			std::swap(_up_webm_frame, _up_held_frame);
+			return true;
+		}
+		return
+			_up_webm_demuxer->readFrame(_up_webm_frame.get(), NULL) // get video frame, only
+			&& _up_webm_frame->isValid(); // check frame for validity
+	}
+
+	// Whether the frame to decode is dropped instead of decoded
+	bool VideoWalkerImpl::drop_next()
+	{
+		if (!_p_unselected)
+		{
+			return false;
+		}
+
+		// Every frame read passes the selection, only frames that nothing references may be dropped
+		VPXDecoder::FrameHeader header;
+		const bool known = _up_vpx_decoder->peekHeader(*_up_webm_frame.get(), header);
+		if (!(*_p_unselected)(_up_webm_frame->time, !known || header.shown) || !known || header.reference)
+		{
+			return false;
+		}
+
+		// Frame threading decodes ahead, so a dropped frame could lie past the last image the walk hands out
+		double pending_time = 0.0;
+		if (_up_vpx_decoder->getPendingTime(pending_time))
+		{
+			return false;
+		}
+
+		// VP9 predicts motion vectors from the previous frame, so read the following frame ahead to tell
+		if (!_up_webm_demuxer->readFrame(_up_held_frame.get(), NULL) || !_up_held_frame->isValid())
+		{
+			return true;
+		}
+		_held = true;
+		VPXDecoder::FrameHeader following;
+		return _up_vpx_decoder->peekHeader(*_up_held_frame.get(), following) && following.independent;
+	}
+
+	// Decode until the next image that walks deliver
+	bool VideoWalkerImpl::decode_next_unique()
+	{
+		while (decode_next())
+		{
+			if (!_duplicate || !_duplicates.suppress)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Compare the current decoded image with the last image that was not a duplicate
+	void VideoWalkerImpl::detect_duplicate()
+	{
+		_duplicate = false;
+		if (!_duplicates.enabled || !_vpx_image_valid)
+		{
+			return;
+		}
+
+		// Chroma planes are compared as well, as encoders refine colour while luma stays the same. Sum of absolute
+		// differences stops early once the threshold is exceeded.
+		const int width = _vpx_image.getWidth(0);
+		const int height = _vpx_image.getHeight(0);
+		if (_has_reference && width == _reference.width && height == _reference.height)
+		{
+			const unsigned long long max_sad = (unsigned long long)(std::max(_duplicates.threshold, 0.0) * width * height);
+			unsigned long long sad = 0;
+			for (int plane = 0; plane < 3 && sad <= max_sad; ++plane)
+			{
+				sad += plane_sad(
+					_vpx_image.planes[plane], _vpx_image.linesize[plane],
+					_reference.p_data[plane], _reference.linesize[plane],
+					_vpx_image.getWidth(plane), _vpx_image.getHeight(plane), max_sad - sad);
+			}
+			_duplicate = sad <= max_sad;
+		}
+
+		// Keep planes as reference of the following frames
+		if (!_duplicate)
+		{
+			_reference = pack_planes(_vpx_image, _reference_data);
+			_has_reference = true;
+		}
+	}
+
+	// Convert the current decoded image into BGR output image
+	Status VideoWalkerImpl::convert(Image& output_image) const
+	{
+		output_image.duplicate = _duplicate;
+		return convert_image(_vpx_image, _vpx_image_valid, output_image);
+	}
+
+	// Wait until the followed file grows
+	bool VideoWalkerImpl::wait_for_data()
+	{
+		// Poll size of file, doubling the interval while nothing is written
+		const std::chrono::steady_clock::time_point idle_since = std::chrono::steady_clock::now();
+		std::chrono::milliseconds interval = std::max(_follow.min_poll_interval, std::chrono::milliseconds(1));
+		while (!_p_reader->refresh())
+		{
+			if ((_p_interrupt && (*_p_interrupt)() != Status::OK) || std::chrono::steady_clock::now() - idle_since >= _follow.idle_timeout)
+			{
+				return false;
+			}
+			std::this_thread::sleep_for(interval);
+			interval = std::min(interval * 2, std::max(_follow.max_poll_interval, interval));
+		}
+		return true;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+// Test of walk_cfr on a variable frame rate video, whose frames are 40, 40 and
+// 20 ms apart, so most of them fall between the ticks. Each tick must show the
+// last frame at or before its time, and ticks must end with the video.
+//   test_cfr vfr.webm
+
+#include "libsimplewebm.hpp"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Check walk_cfr at fps against the frame times of a complete walk, returns count of failures
+int check(const char* path, const double fps, const std::vector<double>& times, const double duration)
+{
+	auto sp_ticks = std::make_shared<std::vector<std::shared_ptr<const simplewebm::Image> > >();
+	unsigned int tick_count = 0;
+	const simplewebm::Status status = simplewebm::create_video_walker(path)->walk_cfr(fps, sp_ticks, &tick_count);
+	int failures = 0;
+	if (status != simplewebm::Status::DONE || tick_count != sp_ticks->size())
+	{
+		printf("fps %.2f: status %d, %u ticks counted, %u handed over\n", fps, (int)status, tick_count, (unsigned int)sp_ticks->size());
+		++failures;
+	}
+
+	// Expected frame of each tick, frame times are rounded to milliseconds
+	std::vector<double> expected;
+	for (int k = 0; times.front() + k / fps < duration - 0.0005; ++k)
+	{
+		const double tick_time = times.front() + k / fps;
+		double shown = times.front();
+		for (double time : times)
+		{
+			if (time <= tick_time + 0.0005)
+			{
+				shown = time;
+			}
+		}
+		expected.push_back(shown);
+	}
+	if (expected.size() != sp_ticks->size())
+	{
+		printf("fps %.2f: %u ticks instead of %u\n", fps, (unsigned int)sp_ticks->size(), (unsigned int)expected.size());
+		return failures + 1;
+	}
+	for (size_t k = 0; k < expected.size(); ++k)
+	{
+		if ((*sp_ticks)[k]->time != expected[k])
+		{
+			printf("fps %.2f: tick %u shows frame at %.3f instead of %.3f\n", fps, (unsigned int)k, (*sp_ticks)[k]->time, expected[k]);
+			++failures;
+		}
+	}
+	return failures;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: test_cfr vfr.webm\n");
+		return 1;
+	}
+
+	// Frame times and duration
+	std::vector<double> times;
+	simplewebm::create_video_walker(argv[1])->walk([&times](const simplewebm::Image& image)
+	{
+		times.push_back(image.time);
+		return true;
+	});
+	simplewebm::VideoInfo info;
+	if (times.empty() || simplewebm::probe(argv[1], info) != simplewebm::Status::OK || info.duration <= times.back())
+	{
+		printf("Cannot read %s\n", argv[1]);
+		return 1;
+	}
+
+	// Ticks on exact frame times, between frame times, and more ticks than frames
+	int failures = 0;
+	for (double fps : { 10.0, 24.0, 30.0, 60.0 })
+	{
+		failures += check(argv[1], fps, times, info.duration);
+	}
+	printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}
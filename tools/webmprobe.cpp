@@ -0,0 +1,216 @@
+/*
+*    MIT License
+*
+*    Copyright (c) 2018 Raphael Menges
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a copy
+*    of this software and associated documentation files (the "Software"), to deal
+*    in the Software without restriction, including without limitation the rights
+*    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*    copies of the Software, and to permit persons to whom the Software is
+*    furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in all
+*    copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*    SOFTWARE.
+*/
+
+// Inventory of WebM files. Probes every given file and every .webm file below
+// the given directories on a thread pool and prints one record per file, either
+// as CSV or as a binary table. Without arguments, paths are read from stdin.
+//   webmprobe [--binary] [--threads N] <file or directory> ...
+
+#include "libsimplewebm.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// Collect .webm files below path, or path itself when it is no directory
+void collect(const std::string& path, std::vector<std::string>& files)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((path + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		files.push_back(path);
+		return;
+	}
+	do
+	{
+		const std::string name(data.cFileName);
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			collect(path + "\\" + name, files);
+		}
+		else if (name.size() > 5 && _stricmp(name.c_str() + name.size() - 5, ".webm") == 0)
+		{
+			files.push_back(path + "\\" + name);
+		}
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR* p_dir = opendir(path.c_str());
+	if (!p_dir)
+	{
+		files.push_back(path);
+		return;
+	}
+	while (dirent* p_entry = readdir(p_dir))
+	{
+		const std::string name(p_entry->d_name);
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		const std::string child = path + "/" + name;
+		struct stat info;
+		if (stat(child.c_str(), &info) != 0)
+		{
+			continue;
+		}
+		if (S_ISDIR(info.st_mode))
+		{
+			collect(child, files);
+		}
+		else if (name.size() > 5 && strcasecmp(name.c_str() + name.size() - 5, ".webm") == 0)
+		{
+			files.push_back(child);
+		}
+	}
+	closedir(p_dir);
+#endif
+}
+
+// Names of enumerations
+const char* codec_name(simplewebm::VideoCodec codec)
+{
+	switch (codec)
+	{
+	case simplewebm::VideoCodec::VP8: return "vp8";
+	case simplewebm::VideoCodec::VP9: return "vp9";
+	default: return "";
+	}
+}
+const char* audio_codec_name(simplewebm::AudioCodec codec)
+{
+	switch (codec)
+	{
+	case simplewebm::AudioCodec::VORBIS: return "vorbis";
+	case simplewebm::AudioCodec::OPUS: return "opus";
+	default: return "";
+	}
+}
+
+// Write little endian values of the binary table
+void put(std::string& out, unsigned long long value, int bytes)
+{
+	for (int i = 0; i < bytes; ++i)
+	{
+		out.push_back((char)((value >> (8 * i)) & 0xFF));
+	}
+}
+void put_double(std::string& out, double value)
+{
+	unsigned long long bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+	put(out, bits, 8);
+}
+
+int main(int argc, char** argv)
+{
+	// Parse arguments
+	bool binary = false;
+	int threads = 0;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--binary") == 0)
+		{
+			binary = true;
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = std::atoi(argv[++i]);
+		}
+		else
+		{
+			collect(argv[i], files);
+		}
+	}
+	if (argc == 1 || (files.empty() && (binary || threads > 0)))
+	{
+		std::string line;
+		while (std::getline(std::cin, line))
+		{
+			if (!line.empty())
+			{
+				files.push_back(line);
+			}
+		}
+	}
+
+	// Probe files
+	const std::vector<simplewebm::ProbeRecord> records = simplewebm::probe_all(files, threads);
+
+	if (binary)
+	{
+		// Table with header "SWPB", version and record count, followed by one record per file
+		std::string out("SWPB");
+		put(out, 1, 4);
+		put(out, records.size(), 4);
+		for (const simplewebm::ProbeRecord& record : records)
+		{
+			put(out, record.path.size(), 2);
+			out += record.path;
+			put(out, (unsigned long long)record.status, 1);
+			put(out, (unsigned long long)record.info.codec, 1);
+			put(out, (unsigned long long)record.info.audio_codec, 1);
+			put(out, (record.info.has_cues ? 1 : 0) | (record.duration_estimated ? 2 : 0), 1); // flags
+			put(out, (unsigned long long)record.info.width, 4);
+			put(out, (unsigned long long)record.info.height, 4);
+			put_double(out, record.info.duration);
+			put_double(out, record.info.frame_rate);
+			put(out, (unsigned long long)record.file_size, 8);
+			put(out, (unsigned long long)record.frame_count, 8);
+			put(out, (unsigned long long)record.cue_count, 4);
+			put_double(out, record.keyframe_interval);
+		}
+		std::fwrite(out.data(), 1, out.size(), stdout);
+	}
+	else
+	{
+		std::printf("path,status,codec,width,height,duration,duration_estimated,frame_rate,frame_count,keyframe_interval,cues,audio,size\n");
+		for (const simplewebm::ProbeRecord& record : records)
+		{
+			std::printf("\"%s\",%d,%s,%d,%d,%.3f,%d,%.3f,%lld,%.3f,%ld,%s,%lld\n",
+				record.path.c_str(), (int)record.status, codec_name(record.info.codec),
+				record.info.width, record.info.height, record.info.duration, record.duration_estimated ? 1 : 0, record.info.frame_rate,
+				record.frame_count, record.keyframe_interval, record.cue_count,
+				audio_codec_name(record.info.audio_codec), record.file_size);
+		}
+	}
+
+	return 0;
+}